@@ -1,12 +1,18 @@
 #include "lottie_animation.h"
+#include "lottie_render_pool.h"
+#include "lottie_frame_buffer_pool.h"
+#include "lottie_render_scheduler.h"
+#include "lottie_pixel_ops.h"
+#include "lottie_archive.h"
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
 #include <godot_cpp/classes/rendering_server.hpp>
+#include <godot_cpp/classes/rendering_device.hpp>
+#include <godot_cpp/classes/rd_texture_format.hpp>
+#include <godot_cpp/classes/rd_texture_view.hpp>
 #include <godot_cpp/classes/project_settings.hpp>
 #include <godot_cpp/classes/file_access.hpp>
 #include <godot_cpp/classes/dir_access.hpp>
-#include <godot_cpp/classes/zip_reader.hpp>
-#include <godot_cpp/classes/json.hpp>
 #include <godot_cpp/classes/node2d.hpp>
 #include <godot_cpp/classes/viewport.hpp>
 #include <godot_cpp/classes/camera2d.hpp>
@@ -15,136 +21,168 @@
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include <thorvg.h>
 
 using namespace godot;
 
-#if defined(__SSSE3__)
-    #include <tmmintrin.h>
-    #define LOTTIE_SIMD_SSSE3 1
-#endif
-#if defined(__ARM_NEON)
-    #include <arm_neon.h>
-    #define LOTTIE_SIMD_NEON 1
-#endif
-
-static inline void _convert_argb_to_rgba_optimized(const uint32_t *src, uint8_t *dst, size_t count) {
-#if LOTTIE_SIMD_SSSE3
-    size_t vec_count = count / 4;
-    const __m128i mask = _mm_setr_epi8(
-        2, 1, 0, 3,
-        6, 5, 4, 7,
-        10, 9, 8, 11,
-        14, 13, 12, 15
-    );
-    const __m128i *srcv = reinterpret_cast<const __m128i*>(src);
-    __m128i *dstv = reinterpret_cast<__m128i*>(dst);
-    for (size_t i = 0; i < vec_count; ++i) {
-        __m128i pixels = _mm_loadu_si128(&srcv[i]);
-        __m128i shuffled = _mm_shuffle_epi8(pixels, mask);
-        _mm_storeu_si128(&dstv[i], shuffled);
-    }
-    size_t processed = vec_count * 4;
-    for (size_t i = processed; i < count; ++i) {
-        uint32_t p = src[i];
-        dst[i*4 + 0] = (uint8_t)((p >> 16) & 0xFF);
-        dst[i*4 + 1] = (uint8_t)((p >> 8) & 0xFF);
-        dst[i*4 + 2] = (uint8_t)(p & 0xFF);
-        dst[i*4 + 3] = (uint8_t)((p >> 24) & 0xFF);
-    }
-#elif LOTTIE_SIMD_NEON
-    size_t vec_count = count / 4;
-    static const uint8_t tbl_data[16] = {
-        2,1,0,3, 6,5,4,7, 10,9,8,11, 14,13,12,15
-    };
-    uint8x16_t tbl = vld1q_u8(tbl_data);
-    for (size_t i = 0; i < vec_count; ++i) {
-        uint8x16_t pixels = vld1q_u8(reinterpret_cast<const uint8_t*>(&src[i*4]));
-#if defined(__aarch64__) || defined(__ARM_FEATURE_QBIT)
-        uint8x16_t shuffled = vqtbl1q_u8(pixels, tbl);
-#else
-        uint8_t tmp[16];
-        vst1q_u8(tmp, pixels);
-        uint8_t out[16];
-        for (int k=0;k<16;k++) out[k] = tmp[tbl_data[k]];
-        pixels = vld1q_u8(out);
-        uint8x16_t shuffled = pixels;
-#endif
-        vst1q_u8(&dst[i*16], shuffled);
-    }
-    size_t processed = vec_count * 4;
-    for (size_t i = processed; i < count; ++i) {
-        uint32_t p = src[i];
-        dst[i*4 + 0] = (uint8_t)((p >> 16) & 0xFF);
-        dst[i*4 + 1] = (uint8_t)((p >> 8) & 0xFF);
-        dst[i*4 + 2] = (uint8_t)(p & 0xFF);
-        dst[i*4 + 3] = (uint8_t)((p >> 24) & 0xFF);
-    }
-#else
-    for (size_t i = 0; i < count; ++i) {
-        uint32_t p = src[i];
-        dst[i*4 + 0] = (uint8_t)((p >> 16) & 0xFF);
-        dst[i*4 + 1] = (uint8_t)((p >> 8) & 0xFF);
-        dst[i*4 + 2] = (uint8_t)(p & 0xFF);
-        dst[i*4 + 3] = (uint8_t)((p >> 24) & 0xFF);
+// Canvas pixel layout: straight ARGB words for the post-processed path, or premultiplied
+// ABGR words, which are RGBA8 bytes in memory on little-endian and upload as-is.
+static tvg::ColorSpace _target_colorspace(bool premultiplied) {
+    return premultiplied ? tvg::ColorSpace::ABGR8888 : tvg::ColorSpace::ARGB8888S;
+}
+
+// Loads a picture from in-memory JSON when there is one, else from the absolute path.
+static bool _load_picture(tvg::Picture *picture, const std::string &path8, const PackedByteArray &json) {
+    if (!json.is_empty()) {
+        return picture->load(reinterpret_cast<const char *>(json.ptr()), (uint32_t)json.size(), "lottie", nullptr, true) == tvg::Result::Success;
+    }
+    return picture->load(path8.c_str()) == tvg::Result::Success;
+}
+
+// A frame whose changed rect covers at least DIFF_SKIP_AREA of it stops diffing for the next
+// DIFF_SKIP_FRAMES frames: the scan would cost a full read of both frames and save nothing.
+static constexpr float DIFF_SKIP_AREA = 0.75f;
+static constexpr int DIFF_SKIP_FRAMES = 8;
+
+bool LottieAnimation::FrameDiff::update(const uint32_t *src, int p_w, int p_h, bool p_unpremultiply, bool p_fix_border, bool p_premultiplied, Rect2i &r_dirty) {
+    const size_t pixels = (size_t)p_w * (size_t)p_h;
+    if (!valid || w != p_w || h != p_h || unpremultiply != p_unpremultiply || fix_border != p_fix_border || premultiplied != p_premultiplied || (size_t)rgba.size() != pixels * 4) {
+        argb.assign(src, src + pixels);
+        w = p_w;
+        h = p_h;
+        unpremultiply = p_unpremultiply;
+        fix_border = p_fix_border;
+        premultiplied = p_premultiplied;
+        valid = true;
+        skip_frames = 0;
+        r_dirty = Rect2i(0, 0, w, h);
+        return true;
     }
-#endif
+    if (skip_frames > 0) {
+        // argb goes stale while skipping; the last skipped frame becomes the next reference.
+        if (--skip_frames == 0) argb.assign(src, src + pixels);
+        r_dirty = Rect2i(0, 0, w, h);
+        return true;
+    }
+    int x0 = w, x1 = -1, y0 = h, y1 = -1;
+    for (int y = 0; y < h; ++y) {
+        const uint32_t *a = src + (size_t)y * (size_t)w;
+        uint32_t *b = argb.data() + (size_t)y * (size_t)w;
+        if (memcmp(a, b, (size_t)w * 4) == 0) continue;
+        int l = 0;
+        while (a[l] == b[l]) ++l;
+        int r = w - 1;
+        while (a[r] == b[r]) --r;
+        memcpy(b + l, a + l, (size_t)(r - l + 1) * 4);
+        x0 = std::min(x0, l);
+        x1 = std::max(x1, r);
+        if (y0 > y) y0 = y;
+        y1 = y;
+    }
+    if (y1 < 0) return false;
+    r_dirty = Rect2i(x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+    if ((float)r_dirty.get_area() >= DIFF_SKIP_AREA * (float)pixels) skip_frames = DIFF_SKIP_FRAMES;
+    return true;
 }
 
-void LottieAnimation::_fix_alpha_border_rgba(uint8_t *rgba, int w, int h) {
-    if (!rgba || w <= 2 || h <= 2) return;
-    std::vector<uint8_t> rgb_copy((size_t)w * (size_t)h * 3);
-    for (int y = 0; y < h; ++y) {
-        const uint8_t *row = rgba + (size_t)y * (size_t)w * 4;
-        uint8_t *dst = rgb_copy.data() + (size_t)y * (size_t)w * 3;
-        for (int x = 0; x < w; ++x) {
-            dst[x*3+0] = row[x*4+0];
-            dst[x*3+1] = row[x*4+1];
-            dst[x*3+2] = row[x*4+2];
+PackedByteArray LottieAnimation::FrameDiff::produce(const uint32_t *src, const Rect2i &dirty, Rect2i &r_changed) {
+    const Rect2i whole(0, 0, w, h);
+    const int64_t bytes = (int64_t)w * (int64_t)h * 4;
+    // The alpha-border fix reads one pixel around what it writes, so pixels next to the
+    // changed ones must be redone; everything further out is unchanged.
+    r_changed = dirty == whole || premultiplied ? dirty : dirty.grow(1).intersection(whole);
+    PackedByteArray out = back;
+    back = PackedByteArray();
+    Rect2i r = r_changed;
+    if (out.size() != bytes || rgba.size() != bytes) {
+        out = LottieFrameBufferPool::get_singleton()->acquire(bytes);
+        r = whole;
+    } else {
+        // `out` holds the frame before last: it is stale where that frame changed and where this one does.
+        r = r.merge(back_stale);
+    }
+    uint8_t *dst = out.ptrw(); // copies only if the older frame is still shared (cache, pending upload)
+    if (premultiplied) {
+        LottiePixelOps::copy_rect(src, dst, w, r.position.x, r.position.y, r.position.x + r.size.x, r.position.y + r.size.y);
+    } else {
+        LottiePixelOps::post_process(src, dst, w, h, r.position.x, r.position.y, r.position.x + r.size.x, r.position.y + r.size.y, unpremultiply, fix_border);
+    }
+    back = rgba;
+    back_stale = r_changed;
+    rgba = out;
+    return out;
+}
+
+// Self-contained ThorVG canvas/picture for background work (frame baking) that must not
+// touch a node's worker picture. Each instance is used by one thread at a time.
+struct _OffscreenRenderer {
+    tvg::SwCanvas *canvas = nullptr;
+    tvg::Animation *animation = nullptr;
+    tvg::Picture *picture = nullptr;
+    std::vector<uint32_t> buffer;
+    Vector2i size;
+    float pw = 0.0f;
+    float ph = 0.0f;
+    bool premultiplied = false;
+
+    ~_OffscreenRenderer() {
+        if (canvas) {
+            if (picture) canvas->remove();
+            delete canvas;
         }
+        delete animation; // owns the picture; also covers the failed load() paths
     }
-    auto at = [&](int x, int y)->uint8_t* { return rgba + ((size_t)y * (size_t)w + (size_t)x) * 4; };
-    auto at_rgb = [&](int x, int y)->const uint8_t* { return rgb_copy.data() + ((size_t)y * (size_t)w + (size_t)x) * 3; };
-    for (int y = 1; y < h-1; ++y) {
-        for (int x = 1; x < w-1; ++x) {
-            uint8_t *px = at(x,y);
-            if (px[3] != 0) continue;
-            bool copied = false;
-            for (int dy = -1; dy <= 1 && !copied; ++dy) {
-                for (int dx = -1; dx <= 1 && !copied; ++dx) {
-                    if (dx == 0 && dy == 0) continue;
-                    uint8_t *n = at(x+dx, y+dy);
-                    if (n[3] > 0) {
-                        const uint8_t *nrgb = at_rgb(x+dx, y+dy);
-                        px[0] = nrgb[0];
-                        px[1] = nrgb[1];
-                        px[2] = nrgb[2];
-                        copied = true;
-                    }
-                }
-            }
+
+    bool load(const std::string &path8, const PackedByteArray &json, int engine_option, bool p_premultiplied) {
+        premultiplied = p_premultiplied;
+        canvas = tvg::SwCanvas::gen(engine_option == 1 ? tvg::EngineOption::SmartRender : tvg::EngineOption::Default);
+        if (!canvas) return false;
+        animation = tvg::Animation::gen();
+        picture = animation->picture();
+        if (!picture || !_load_picture(picture, path8, json)) {
+            picture = nullptr;
+            return false;
         }
+        picture->size(&pw, &ph);
+        if (canvas->push(picture) != tvg::Result::Success) {
+            picture = nullptr;
+            return false;
+        }
+        return true;
     }
-}
 
-void LottieAnimation::_unpremultiply_alpha_rgba(uint8_t *rgba, int w, int h) {
-    if (!rgba || w <= 0 || h <= 0) return;
-    const size_t pixels = (size_t)w * (size_t)h;
-    uint8_t *p = rgba;
-    for (size_t i = 0; i < pixels; ++i, p += 4) {
-        uint8_t a = p[3];
-        if (a == 0) {
-            p[0] = p[1] = p[2] = 0;
-            continue;
+    // Renders `frame` at `target` size and writes post-processed (or premultiplied) RGBA8 into dst (w*h*4 bytes).
+    void render(float frame, const Vector2i &target, bool unpremultiply, bool fix_border, uint8_t *dst) {
+        if (size != target) {
+            size = target;
+            buffer.assign((size_t)size.x * (size_t)size.y, 0u);
+            canvas->target(buffer.data(), size.x, size.x, size.y, _target_colorspace(premultiplied));
+            float bw = std::max(1.0f, pw > 0.0f ? pw : (float)size.x);
+            float bh = std::max(1.0f, ph > 0.0f ? ph : (float)size.y);
+            float s = std::min((float)size.x / bw, (float)size.y / bh);
+            tvg::Matrix m;
+            m.e11 = s;   m.e12 = 0.0f; m.e13 = (size.x - bw * s) * 0.5f;
+            m.e21 = 0.0f; m.e22 = s;   m.e23 = (size.y - bh * s) * 0.5f;
+            m.e31 = 0.0f; m.e32 = 0.0f; m.e33 = 1.0f;
+            picture->transform(m);
         }
-        if (a == 255) continue;
-        p[0] = (uint8_t)std::min(255, (int)((int)p[0] * 255 + (a / 2)) / (int)a);
-        p[1] = (uint8_t)std::min(255, (int)((int)p[1] * 255 + (a / 2)) / (int)a);
-        p[2] = (uint8_t)std::min(255, (int)((int)p[2] * 255 + (a / 2)) / (int)a);
+        animation->frame(frame);
+        canvas->update();
+        canvas->draw(false);
+        canvas->sync();
+        if (premultiplied) {
+            memcpy(dst, buffer.data(), buffer.size() * 4);
+            return;
+        }
+        LottiePixelOps::post_process(buffer.data(), dst, size.x, size.y, 0, 0, size.x, size.y, unpremultiply, fix_border);
     }
-}
+};
 
 static String _mirror_file_to_user_cache(const String &src_path) {
     if (src_path.is_empty()) return String();
@@ -163,47 +201,17 @@ static String _mirror_file_to_user_cache(const String &src_path) {
     fo->close();
     return mirror_rel;
 }
-static String _extract_lottie_json_to_cache(const String &zip_path, const String &preferred_entry = String()) {
-    Ref<ZIPReader> zr;
-    zr.instantiate();
-    if (zr.is_null()) {
-        UtilityFunctions::printerr("Failed to open .lottie (zip): " + zip_path);
-        return String();
-    }
-
-    String open_path = zip_path;
-    Error zerr = zr->open(open_path);
-    if (zerr != OK) {
-        // On Web or when file is packed in PCK, mirror to user:// and try again.
-        String mirrored = _mirror_file_to_user_cache(zip_path);
-        if (!mirrored.is_empty()) {
-            zerr = zr->open(mirrored);
-            if (zerr == OK) {
-                open_path = mirrored;
-            }
-        }
-    }
-    if (zerr != OK) {
-        UtilityFunctions::printerr("Failed to open .lottie (zip): " + zip_path);
-        return String();
-    }
-
-    PackedStringArray files = zr->get_files();
-    const String cache_root = String("user://lottie_cache");
-    String abs_cache_root = ProjectSettings::get_singleton()->globalize_path(cache_root);
-    DirAccess::make_dir_recursive_absolute(abs_cache_root);
-    String hash_name = String::num_uint64((uint64_t)zip_path.hash());
-    String cache_dir = cache_root.path_join(hash_name);
-    String abs_cache_dir = ProjectSettings::get_singleton()->globalize_path(cache_dir);
-    DirAccess::make_dir_recursive_absolute(abs_cache_dir);
 
+// Chooses the animation JSON inside a .lottie: the preferred entry (path, id or substring),
+// else the first animations/*.json, data.json, or any non-manifest JSON.
+static String _pick_dotlottie_json_entry(const LottieArchive &archive, const String &preferred_entry) {
+    const PackedStringArray &files = archive.get_files();
     String json_inside;
-    auto file_exists_in_zip = [&](const String &p){ for (int i=0;i<files.size();++i){ if (files[i]==p) return true; } return false; };
     if (!preferred_entry.is_empty()) {
-        if (file_exists_in_zip(preferred_entry)) json_inside = preferred_entry;
+        if (archive.has_file(preferred_entry)) json_inside = preferred_entry;
         if (json_inside.is_empty()) {
             String alt = String("animations/") + preferred_entry + ".json";
-            if (file_exists_in_zip(alt)) json_inside = alt;
+            if (archive.has_file(alt)) json_inside = alt;
         }
         if (json_inside.is_empty()) {
             String needle = preferred_entry.to_lower();
@@ -234,12 +242,109 @@ static String _extract_lottie_json_to_cache(const String &zip_path, const String
             }
         }
     }
+    return json_inside;
+}
+
+// What an extracted bundle was extracted from. Written to <cache_dir>/.extracted after every
+// entry is on disk, so loading an unchanged bundle again is a metadata comparison.
+struct _BundleStamp {
+    int64_t size = -1;
+    uint64_t mtime = 0;
+    String md5; // only computed when size/mtime alone cannot decide
+};
+
+static _BundleStamp _stat_bundle(const String &path) {
+    _BundleStamp st;
+    Ref<FileAccess> f = FileAccess::open(path, FileAccess::READ);
+    if (f.is_valid()) {
+        st.size = (int64_t)f->get_length();
+        f->close();
+    }
+    st.mtime = FileAccess::get_modified_time(path);
+    return st;
+}
+
+static _BundleStamp _read_bundle_stamp(const String &stamp_path) {
+    _BundleStamp st;
+    Ref<FileAccess> f = FileAccess::open(stamp_path, FileAccess::READ);
+    if (f.is_null()) return st;
+    if (f->get_line() == "LFX1") {
+        st.size = f->get_line().to_int();
+        st.mtime = (uint64_t)f->get_line().to_int();
+        st.md5 = f->get_line();
+    }
+    f->close();
+    return st;
+}
+
+static void _write_bundle_stamp(const String &stamp_path, const _BundleStamp &st) {
+    Ref<FileAccess> f = FileAccess::open(stamp_path, FileAccess::WRITE);
+    if (f.is_null()) return;
+    f->store_line("LFX1");
+    f->store_line(String::num_int64(st.size));
+    f->store_line(String::num_uint64(st.mtime));
+    f->store_line(st.md5);
+    f->close();
+}
+
+// One lock per cache directory: nodes loading the same bundle at once (main thread and async
+// loads) check and extract it one at a time instead of writing the same files concurrently.
+static std::mutex &_bundle_mutex(const String &cache_dir) {
+    static std::mutex registry_mutex;
+    static std::unordered_map<std::string, std::unique_ptr<std::mutex>> mutexes;
+    std::lock_guard<std::mutex> lk(registry_mutex);
+    std::unique_ptr<std::mutex> &m = mutexes[std::string(cache_dir.utf8().get_data())];
+    if (!m) m.reset(new std::mutex());
+    return *m;
+}
+
+static String _extract_lottie_json_to_cache(const String &zip_path, const String &preferred_entry = String()) {
+    std::shared_ptr<LottieArchive> archive = LottieArchive::open(zip_path);
+    if (!archive) {
+        // On Web or when file is packed in PCK, mirror to user:// and try again.
+        String mirrored = _mirror_file_to_user_cache(zip_path);
+        if (!mirrored.is_empty()) archive = LottieArchive::open(mirrored);
+    }
+    if (!archive) {
+        UtilityFunctions::printerr("Failed to open .lottie (zip): " + zip_path);
+        return String();
+    }
+    const String &open_path = archive->get_path();
+    const PackedStringArray &files = archive->get_files();
+    const String cache_root = String("user://lottie_cache");
+    String abs_cache_root = ProjectSettings::get_singleton()->globalize_path(cache_root);
+    DirAccess::make_dir_recursive_absolute(abs_cache_root);
+    String hash_name = String::num_uint64((uint64_t)zip_path.hash());
+    String cache_dir = cache_root.path_join(hash_name);
+    String abs_cache_dir = ProjectSettings::get_singleton()->globalize_path(cache_dir);
+    DirAccess::make_dir_recursive_absolute(abs_cache_dir);
+
+    String json_inside = _pick_dotlottie_json_entry(*archive, preferred_entry);
     if (json_inside.is_empty()) {
-        zr->close();
         UtilityFunctions::printerr(".lottie does not contain a JSON animation file");
         return String();
     }
 
+    String out_path = cache_dir.path_join(json_inside);
+    const String stamp_path = cache_dir.path_join(".extracted");
+    std::lock_guard<std::mutex> bundle_lock(_bundle_mutex(cache_dir));
+    _BundleStamp current = _stat_bundle(open_path);
+    const _BundleStamp stored = _read_bundle_stamp(stamp_path);
+    if (stored.size >= 0 && stored.size == current.size && FileAccess::file_exists(out_path)) {
+        if (stored.mtime == current.mtime) {
+            return out_path;
+        }
+        // Same size but touched since: compare content before extracting again.
+        current.md5 = FileAccess::get_md5(open_path);
+        if (!stored.md5.is_empty() && stored.md5 == current.md5) {
+            _write_bundle_stamp(stamp_path, current);
+            return out_path;
+        }
+    }
+    if (current.md5.is_empty()) current.md5 = FileAccess::get_md5(open_path);
+    // Drop the old stamp first so an interrupted extraction is redone next time.
+    DirAccess::remove_absolute(ProjectSettings::get_singleton()->globalize_path(stamp_path));
+
     // Extract all files to the cache folder, so relative assets resolve.
     for (int i = 0; i < files.size(); i++) {
         String entry = files[i];
@@ -249,13 +354,7 @@ static String _extract_lottie_json_to_cache(const String &zip_path, const String
         String dest_abs = ProjectSettings::get_singleton()->globalize_path(dest_rel);
         String parent_abs = dest_abs.get_base_dir();
         DirAccess::make_dir_recursive_absolute(parent_abs);
-        Ref<ZIPReader> zr3; zr3.instantiate();
-        if (zr3->open(open_path) != OK) {
-            UtilityFunctions::printerr("Failed to reopen .lottie for extract: " + open_path);
-            return String();
-        }
-        PackedByteArray data = zr3->read_file(entry);
-        zr3->close();
+        PackedByteArray data = archive->read_file(entry);
         Ref<FileAccess> fo = FileAccess::open(dest_rel, FileAccess::WRITE);
         if (fo.is_null()) {
             // Try to create parent again just in case
@@ -268,14 +367,47 @@ static String _extract_lottie_json_to_cache(const String &zip_path, const String
             fo->close();
         }
     }
-    // zr already closed above.
+    _write_bundle_stamp(stamp_path, current);
 
     // Return the chosen JSON inside the extracted cache dir
-    String out_path = cache_dir.path_join(json_inside);
     return out_path;
 }
 
-#include <unordered_map>
+// True when the Lottie JSON references an image by file name rather than embedding it: asset
+// "p" is the only string-valued "p" key (transform "p" is an object), and embedded ones are
+// data: URIs. Such files need their bundle extracted so ThorVG can resolve the images.
+static bool _lottie_json_has_external_assets(const PackedByteArray &json) {
+    const char *s = reinterpret_cast<const char *>(json.ptr());
+    const size_t n = (size_t)json.size();
+    for (size_t i = 0; i + 3 < n; ++i) {
+        if (s[i] != '"' || s[i + 1] != 'p' || s[i + 2] != '"') continue;
+        size_t j = i + 3;
+        while (j < n && (s[j] == ' ' || s[j] == '\t' || s[j] == '\n' || s[j] == '\r')) ++j;
+        if (j >= n || s[j] != ':') continue;
+        ++j;
+        while (j < n && (s[j] == ' ' || s[j] == '\t' || s[j] == '\n' || s[j] == '\r')) ++j;
+        if (j >= n || s[j] != '"') continue;
+        ++j;
+        if (n - j < 5 || memcmp(s + j, "data:", 5) != 0) return true;
+    }
+    return false;
+}
+
+// Reads the animation JSON of a .lottie straight from the archive for ThorVG's in-memory
+// loader. Fails (and callers fall back to extraction) when the archive cannot be opened in
+// place or the animation needs image files from the bundle. r_key names the entry for caches.
+static bool _read_lottie_json_from_zip(const String &zip_path, const String &preferred_entry, PackedByteArray &r_json, String &r_key) {
+    std::shared_ptr<LottieArchive> archive = LottieArchive::open(zip_path);
+    if (!archive) return false;
+    String json_inside = _pick_dotlottie_json_entry(*archive, preferred_entry);
+    if (json_inside.is_empty()) return false;
+    PackedByteArray json = archive->read_file(json_inside);
+    if (json.is_empty() || _lottie_json_has_external_assets(json)) return false;
+    r_json = json;
+    r_key = zip_path + "::" + json_inside;
+    return true;
+}
+
 static std::unordered_map<std::string, int> g_anim_usage_counts;
 static inline void _registry_inc(const String &key) {
     if (key.is_empty()) return;
@@ -293,227 +425,52 @@ static inline int _registry_get(const String &key) {
     return it == g_anim_usage_counts.end() ? 0 : it->second;
 }
 
-void LottieAnimation::_parse_dotlottie_manifest(const String &zip_path) {
-    last_lottie_zip_path = zip_path;
-    sm_animation_ids.clear();
-    sm_machine_names.clear();
-    sm_states_by_machine.clear();
-    sm_anim_inner_paths.clear();
-    sm_state_segments_by_machine.clear();
-
-    Ref<ZIPReader> zr;
-    zr.instantiate();
-    if (zr.is_null() || zr->open(zip_path) != OK) return;
-    PackedStringArray files = zr->get_files();
-    String manifest_path = "manifest.json";
-    bool manifest_present = false;
-    for (int i = 0; i < files.size(); i++) {
-        String f = files[i];
-        if (f.to_lower().ends_with("manifest.json")) { manifest_path = f; manifest_present = true; break; }
-        if (f == manifest_path) { manifest_present = true; }
-    }
-    if (!manifest_present) { zr->close(); return; }
-    PackedByteArray bytes = zr->read_file(manifest_path);
-    // Keep `files` around for potential state machine discovery below; we'll reopen when reading contents.
-    zr->close();
-
-    String text = bytes.get_string_from_utf8();
-    Variant parsed = JSON::parse_string(text);
-    if (parsed.get_type() != Variant::DICTIONARY) return;
-    Dictionary manifest = parsed;
-
-    // animations: accept array or object map
-    if (manifest.has("animations")) {
-        Variant anv = manifest["animations"];
-        if (anv.get_type() == Variant::ARRAY) {
-            Array arr = anv;
-            for (int i = 0; i < arr.size(); i++) {
-                if (arr[i].get_type() != Variant::DICTIONARY) continue;
-                Dictionary a = arr[i];
-                String id = a.has("id") ? (String)a["id"] : (a.has("name") ? (String)a["name"] : String());
-                if (id.is_empty()) continue;
-                bool dup = false; for (int j = 0; j < sm_animation_ids.size(); j++) { if (sm_animation_ids[j] == id) { dup = true; break; } }
-                if (!dup) sm_animation_ids.push_back(id);
-                if (a.has("lottie")) sm_anim_inner_paths[id] = (String)a["lottie"]; // e.g. animations/<id>.json
-                else if (a.has("path")) sm_anim_inner_paths[id] = (String)a["path"]; // alias used by some tools
-                else sm_anim_inner_paths[id] = String("animations/") + id + ".json";
-            }
-        } else if (anv.get_type() == Variant::DICTIONARY) {
-            Dictionary amap = anv;
-            Array keys = amap.keys();
-            for (int i = 0; i < keys.size(); i++) {
-                String id = (String)keys[i];
-                Dictionary a = amap[id];
-                bool dup = false; for (int j = 0; j < sm_animation_ids.size(); j++) { if (sm_animation_ids[j] == id) { dup = true; break; } }
-                if (!dup) sm_animation_ids.push_back(id);
-                if (a.has("lottie")) sm_anim_inner_paths[id] = (String)a["lottie"];
-                else if (a.has("path")) sm_anim_inner_paths[id] = (String)a["path"]; 
-                else sm_anim_inner_paths[id] = String("animations/") + id + ".json";
-            }
-        }
-    }
-    // state machines: accept array or map; states can be array, map, or nodes list
-    auto parse_states_from_variant = [](const Variant &sv) {
-        PackedStringArray out;
-        if (sv.get_type() == Variant::ARRAY) {
-            Array st = sv;
-            for (int k = 0; k < st.size(); k++) {
-                if (st[k].get_type() == Variant::DICTIONARY) {
-                    Dictionary sd = st[k];
-                    if (sd.has("name")) out.push_back((String)sd["name"]);
-                    else if (sd.has("id")) out.push_back((String)sd["id"]);
-                } else if (st[k].get_type() == Variant::STRING) {
-                    out.push_back((String)st[k]);
-                }
-            }
-        } else if (sv.get_type() == Variant::DICTIONARY) {
-            Dictionary st = sv;
-            Array keys = st.keys();
-            for (int k = 0; k < keys.size(); k++) {
-                String key = (String)keys[k];
-                Variant v = st[key];
-                if (v.get_type() == Variant::DICTIONARY) {
-                    Dictionary sd = v;
-                    if (sd.has("name")) out.push_back((String)sd["name"]);
-                    else out.push_back(key);
-                } else {
-                    out.push_back(key);
-                }
-            }
-        }
-        return out;
+// Shared-instance frames, keyed by (cache id, render size). Main thread only.
+// A slot keeps one uploaded frame; it is only rewritten once no node has shown it for
+// a couple of process frames, so borrowers never see a frame change under them.
+struct _SharedFrameGroup {
+    struct Slot {
+        int qf = -1;
+        Ref<ImageTexture> texture;
+        uint64_t last_used = 0;
     };
-
-    if (manifest.has("stateMachines")) {
-        Variant smv = manifest["stateMachines"];
-        if (smv.get_type() == Variant::ARRAY) {
-            Array sms = smv;
-            for (int i = 0; i < sms.size(); i++) {
-                if (sms[i].get_type() != Variant::DICTIONARY) continue;
-                Dictionary sm = sms[i];
-                String name = sm.has("name") ? (String)sm["name"] : (sm.has("id") ? (String)sm["id"] : String("state_machine"));
-                bool dupm = false; for (int j = 0; j < sm_machine_names.size(); j++) { if (sm_machine_names[j] == name) { dupm = true; break; } }
-                if (!dupm) sm_machine_names.push_back(name);
-                PackedStringArray states;
-                if (sm.has("states")) states = parse_states_from_variant(sm["states"]);
-                // Some tools store nodes instead of states
-                if (states.is_empty() && sm.has("nodes")) states = parse_states_from_variant(sm["nodes"]);
-                sm_states_by_machine[name] = states;
-            }
-        } else if (smv.get_type() == Variant::DICTIONARY) {
-            Dictionary smap = smv;
-            Array mkeys = smap.keys();
-            for (int i = 0; i < mkeys.size(); i++) {
-                String name = (String)mkeys[i];
-                Dictionary sm = smap[name];
-                bool dupm = false; for (int j = 0; j < sm_machine_names.size(); j++) { if (sm_machine_names[j] == name) { dupm = true; break; } }
-                if (!dupm) sm_machine_names.push_back(name);
-                PackedStringArray states;
-                if (sm.has("states")) states = parse_states_from_variant(sm["states"]);
-                if (states.is_empty() && sm.has("nodes")) states = parse_states_from_variant(sm["nodes"]);
-                sm_states_by_machine[name] = states;
-            }
-        }
-    }
-
-    // Supplement: If states are not listed in manifest, try to load state machine JSONs from inside the .lottie zip.
-    auto parse_states_json_text = [](const String &text, Dictionary &out_segments) -> PackedStringArray {
-        PackedStringArray out;
-        out_segments.clear();
-        Variant v = JSON::parse_string(text);
-        if (v.get_type() != Variant::DICTIONARY) return out;
-        Dictionary d = v;
-        if (d.has("states") && d["states"].get_type() == Variant::ARRAY) {
-            Array arr = d["states"];
-            for (int i = 0; i < arr.size(); i++) {
-                if (arr[i].get_type() == Variant::DICTIONARY) {
-                    Dictionary sd = arr[i];
-                    if (sd.has("name")) {
-                        String name = (String)sd["name"];
-                        out.push_back(name);
-                        if (sd.has("segment")) {
-                            out_segments[name] = (String)sd["segment"];
-                        }
-                    }
-                }
-            }
-        }
-        return out;
+    struct Pending {
+        const void *owner = nullptr;
+        uint64_t since = 0;
     };
+    std::vector<Slot> slots;
+    std::unordered_map<int, Pending> pending; // qf -> node whose render is in flight
+    int users = 0;
+};
+static const int SHARED_MAX_SLOTS = 8;
+// A render that has not been published after this many process frames (owner hidden,
+// frame dropped) no longer holds back the other instances.
+static const uint64_t SHARED_PENDING_TIMEOUT = 10;
+static std::unordered_map<uint64_t, _SharedFrameGroup> g_shared_frames;
 
-    auto try_load_states_for_machine = [&](const String &machine_name) -> PackedStringArray {
-        // Heuristics: look for JSON file whose basename equals <machine_name>.json in any folder containing "state"; fallback to any such JSON.
-        PackedStringArray out;
-        Ref<ZIPReader> zr2; zr2.instantiate();
-        if (zr2.is_null() || zr2->open(zip_path) != OK) return out;
-        PackedStringArray fl = zr2->get_files();
-    String target_basename = machine_name + String(".json");
-        String target_basename_lc = target_basename.to_lower();
-        String candidate_path;
-        // 1) Exact basename match inside folders likely holding state machines
-        for (int i = 0; i < fl.size(); i++) {
-            String f = fl[i];
-            if (f.ends_with("/")) continue;
-            String fname = f.get_file();
-            String folder_lc = f.get_base_dir().to_lower();
-            if ((folder_lc.find("state") != -1 || folder_lc.find("machine") != -1) && fname.to_lower() == target_basename_lc) {
-                candidate_path = f; break;
-            }
-        }
-        // 2) Any file containing machine name in a "state" folder
-        if (candidate_path.is_empty()) {
-            String needle = machine_name.to_lower();
-            for (int i = 0; i < fl.size(); i++) {
-                String f = fl[i];
-                if (f.ends_with("/")) continue;
-                String folder_lc = f.get_base_dir().to_lower();
-                String fname_lc = f.get_file().to_lower();
-                if ((folder_lc.find("state") != -1 || folder_lc.find("machine") != -1) && fname_lc.ends_with(".json") && fname_lc.find(needle) != -1) {
-                    candidate_path = f; break;
-                }
-            }
-        }
-        // 3) Fallback: first JSON inside any folder with "state" in path
-        if (candidate_path.is_empty()) {
-            for (int i = 0; i < fl.size(); i++) {
-                String f = fl[i];
-                if (f.ends_with("/")) continue;
-                String lf = f.to_lower();
-                if (lf.ends_with(".json") && lf.find("state") != -1) { candidate_path = f; break; }
-            }
-        }
-        if (!candidate_path.is_empty()) {
-            PackedByteArray bytes2 = zr2->read_file(candidate_path);
-            zr2->close();
-            String text2 = bytes2.get_string_from_utf8();
-            Dictionary segs;
-            out = parse_states_json_text(text2, segs);
-            if (!out.is_empty()) {
-                sm_state_segments_by_machine[machine_name] = segs;
-            }
-        } else {
-            zr2->close();
-        }
-        return out;
-    };
+static inline uint64_t _shared_group_key(uint32_t anim_id, const Vector2i &size) {
+    return ((uint64_t)anim_id << 32) | ((uint64_t)(size.x & 0xFFFF) << 16) | (uint64_t)(size.y & 0xFFFF);
+}
 
-    for (int i = 0; i < sm_machine_names.size(); i++) {
-        String mname = sm_machine_names[i];
-        PackedStringArray existing;
-        if (sm_states_by_machine.has(mname)) existing = (PackedStringArray)sm_states_by_machine[mname];
-        if (existing.is_empty()) {
-            PackedStringArray states = try_load_states_for_machine(mname);
-            if (!states.is_empty()) sm_states_by_machine[mname] = states;
-        }
-    }
-    if (active_animation_id.is_empty() && sm_animation_ids.size() > 0) active_animation_id = sm_animation_ids[0];
-    if (active_state_machine.is_empty() && sm_machine_names.size() > 0) active_state_machine = sm_machine_names[0];
-    PackedStringArray sts;
-    if (sm_states_by_machine.has(active_state_machine)) sts = (PackedStringArray)sm_states_by_machine[active_state_machine];
-    if (active_state.is_empty() && sts.size() > 0) active_state = sts[0];
+void LottieAnimation::_apply_dotlottie_manifest(const String &zip_path, const std::shared_ptr<const LottieManifest> &m, const std::shared_ptr<LottieArchive> &archive) {
+    last_lottie_zip_path = zip_path;
+    dotlottie_manifest = m ? m : LottieManifest::empty();
+    dotlottie_archive = archive;
+    const std::vector<String> &ids = dotlottie_manifest->get_animation_ids();
+    const std::vector<LottieManifest::StateMachine> &machines = dotlottie_manifest->get_state_machines();
+    if (active_animation_id.is_empty() && !ids.empty()) active_animation_id = ids[0];
+    if (active_state_machine.is_empty() && !machines.empty()) active_state_machine = machines[0].name;
+    const std::vector<String> &sts = dotlottie_manifest->get_states(active_state_machine);
+    if (active_state.is_empty() && !sts.empty()) active_state = sts[0];
     notify_property_list_changed();
 }
 
+void LottieAnimation::_parse_dotlottie_manifest(const String &zip_path) {
+    // Opened first so the manifest load and the JSON read that follows share the one handle.
+    std::shared_ptr<LottieArchive> archive = LottieArchive::open(zip_path);
+    _apply_dotlottie_manifest(zip_path, LottieManifest::load(zip_path), archive);
+}
+
 String LottieAnimation::_extract_json_from_lottie_to_cache(const String &zip_path, const String &inner_path, const String &suffix_key) {
     return _extract_lottie_json_to_cache(zip_path, inner_path);
 }
@@ -522,13 +479,14 @@ void LottieAnimation::_get_property_list(List<PropertyInfo> *p_list) const {
     if (animation_path.is_empty() || !animation_path.to_lower().ends_with(".lottie")) return;
     // Build enum hints
     String anim_opts;
-    for (int i = 0; i < sm_animation_ids.size(); i++) { if (i>0) anim_opts += ","; anim_opts += sm_animation_ids[i]; }
+    const std::vector<String> &ids = dotlottie_manifest->get_animation_ids();
+    for (size_t i = 0; i < ids.size(); i++) { if (i>0) anim_opts += ","; anim_opts += ids[i]; }
     String sm_opts;
-    for (int i = 0; i < sm_machine_names.size(); i++) { if (i>0) sm_opts += ","; sm_opts += sm_machine_names[i]; }
+    const std::vector<LottieManifest::StateMachine> &machines = dotlottie_manifest->get_state_machines();
+    for (size_t i = 0; i < machines.size(); i++) { if (i>0) sm_opts += ","; sm_opts += machines[i].name; }
     String st_opts;
-    PackedStringArray states;
-    if (sm_states_by_machine.has(active_state_machine)) states = (PackedStringArray)sm_states_by_machine[active_state_machine];
-    for (int i = 0; i < states.size(); i++) { if (i>0) st_opts += ","; st_opts += states[i]; }
+    const std::vector<String> &states = dotlottie_manifest->get_states(active_state_machine);
+    for (size_t i = 0; i < states.size(); i++) { if (i>0) st_opts += ","; st_opts += states[i]; }
 
     p_list->push_back(PropertyInfo(Variant::STRING, "state/animation", PROPERTY_HINT_ENUM, anim_opts));
     p_list->push_back(PropertyInfo(Variant::STRING, "state/machine", PROPERTY_HINT_ENUM, sm_opts));
@@ -565,9 +523,8 @@ bool LottieAnimation::_set(const StringName &p_name, const Variant &p_value) {
         if (active_state_machine != m) {
             active_state_machine = m;
             // Reset first state of this machine
-            PackedStringArray states;
-            if (sm_states_by_machine.has(m)) states = (PackedStringArray)sm_states_by_machine[m];
-            active_state = states.size() > 0 ? states[0] : String();
+            const std::vector<String> &states = dotlottie_manifest->get_states(m);
+            active_state = !states.empty() ? states[0] : String();
             notify_property_list_changed();
             // Apply first state's segment and play
             _apply_selected_state_segment();
@@ -639,6 +596,25 @@ void LottieAnimation::_bind_methods() {
     ClassDB::bind_method(D_METHOD("get_engine_option"), &LottieAnimation::get_engine_option);
     // Static rendering when idle is now unconditional; only expose render_static() helper.
     ClassDB::bind_method(D_METHOD("render_static"), &LottieAnimation::render_static);
+    ClassDB::bind_method(D_METHOD("bake_frames", "from_frame", "to_frame", "size"), &LottieAnimation::bake_frames, DEFVAL(Vector2i()));
+    ClassDB::bind_method(D_METHOD("cancel_bake"), &LottieAnimation::cancel_bake);
+    ClassDB::bind_method(D_METHOD("is_baking"), &LottieAnimation::is_baking);
+    ClassDB::bind_method(D_METHOD("bake_sprite_atlas", "frame_size", "frame_step", "marker"), &LottieAnimation::bake_sprite_atlas, DEFVAL(1), DEFVAL(String()));
+    ClassDB::bind_method(D_METHOD("clear_sprite_atlas"), &LottieAnimation::clear_sprite_atlas);
+    ClassDB::bind_method(D_METHOD("get_atlas_textures"), &LottieAnimation::get_atlas_textures);
+    ClassDB::bind_method(D_METHOD("get_atlas_frames"), &LottieAnimation::get_atlas_frames);
+    ClassDB::bind_method(D_METHOD("set_atlas_playback", "enable"), &LottieAnimation::set_atlas_playback);
+    ClassDB::bind_method(D_METHOD("is_atlas_playback"), &LottieAnimation::is_atlas_playback);
+    ClassDB::bind_method(D_METHOD("set_shared_instance", "enable"), &LottieAnimation::set_shared_instance);
+    ClassDB::bind_method(D_METHOD("is_shared_instance"), &LottieAnimation::is_shared_instance);
+    ClassDB::bind_method(D_METHOD("set_premultiplied_alpha", "enable"), &LottieAnimation::set_premultiplied_alpha);
+    ClassDB::bind_method(D_METHOD("is_premultiplied_alpha"), &LottieAnimation::is_premultiplied_alpha);
+    ClassDB::bind_method(D_METHOD("set_async_load", "enable"), &LottieAnimation::set_async_load);
+    ClassDB::bind_method(D_METHOD("is_async_load"), &LottieAnimation::is_async_load);
+    ClassDB::bind_method(D_METHOD("set_placeholder_texture", "texture"), &LottieAnimation::set_placeholder_texture);
+    ClassDB::bind_method(D_METHOD("get_placeholder_texture"), &LottieAnimation::get_placeholder_texture);
+    ClassDB::bind_method(D_METHOD("set_render_focus", "focus"), &LottieAnimation::set_render_focus);
+    ClassDB::bind_method(D_METHOD("get_render_focus"), &LottieAnimation::get_render_focus);
     
     ClassDB::bind_method(D_METHOD("get_duration"), &LottieAnimation::get_duration);
     ClassDB::bind_method(D_METHOD("get_total_frames"), &LottieAnimation::get_total_frames);
@@ -646,6 +622,9 @@ void LottieAnimation::_bind_methods() {
     ClassDB::bind_method(D_METHOD("get_culling_mode"), &LottieAnimation::get_culling_mode);
     ClassDB::bind_method(D_METHOD("set_culling_margin_px", "margin"), &LottieAnimation::set_culling_margin_px);
     ClassDB::bind_method(D_METHOD("get_culling_margin_px"), &LottieAnimation::get_culling_margin_px);
+    ClassDB::bind_method(D_METHOD("set_single_picture_owner", "enabled"), &LottieAnimation::set_single_picture_owner);
+    ClassDB::bind_method(D_METHOD("is_single_picture_owner"), &LottieAnimation::is_single_picture_owner);
+    ClassDB::bind_static_method("LottieAnimation", D_METHOD("get_frame_buffer_allocations"), &LottieAnimation::get_frame_buffer_allocations);
     ClassDB::bind_method(D_METHOD("_on_viewport_size_changed"), &LottieAnimation::_on_viewport_size_changed);
     ClassDB::bind_method(D_METHOD("set_offset", "offset"), &LottieAnimation::set_offset);
     ClassDB::bind_method(D_METHOD("get_offset"), &LottieAnimation::get_offset);
@@ -671,13 +650,25 @@ void LottieAnimation::_bind_methods() {
     ADD_PROPERTY(PropertyInfo(Variant::BOOL, "frame_cache/enabled", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_STORAGE | PROPERTY_USAGE_NO_EDITOR), "set_frame_cache_enabled", "is_frame_cache_enabled");
     ADD_PROPERTY(PropertyInfo(Variant::INT, "frame_cache/budget_mb", PROPERTY_HINT_RANGE, "16,4096,16", PROPERTY_USAGE_STORAGE | PROPERTY_USAGE_NO_EDITOR), "set_frame_cache_budget_mb", "get_frame_cache_budget_mb");
     ADD_PROPERTY(PropertyInfo(Variant::INT, "frame_cache/step_frames", PROPERTY_HINT_RANGE, "1,8,1", PROPERTY_USAGE_STORAGE | PROPERTY_USAGE_NO_EDITOR), "set_frame_cache_step", "get_frame_cache_step");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "render_thread/single_picture_owner", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_STORAGE | PROPERTY_USAGE_NO_EDITOR), "set_single_picture_owner", "is_single_picture_owner");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "atlas_playback", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_STORAGE | PROPERTY_USAGE_NO_EDITOR), "set_atlas_playback", "is_atlas_playback");
     ADD_PROPERTY(PropertyInfo(Variant::INT, "engine_option", PROPERTY_HINT_ENUM, "Default,SmartRender", PROPERTY_USAGE_STORAGE | PROPERTY_USAGE_NO_EDITOR), "set_engine_option", "get_engine_option");
     
     ADD_PROPERTY(PropertyInfo(Variant::VECTOR2, "offset"), "set_offset", "get_offset");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "shared_instance"), "set_shared_instance", "is_shared_instance");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "premultiplied_alpha"), "set_premultiplied_alpha", "is_premultiplied_alpha");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "async_load"), "set_async_load", "is_async_load");
+    ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "placeholder_texture", PROPERTY_HINT_RESOURCE_TYPE, "Texture2D"), "set_placeholder_texture", "get_placeholder_texture");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "culling_mode", PROPERTY_HINT_ENUM, "ViewportRect,CameraWorld,Disabled"), "set_culling_mode", "get_culling_mode");
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "culling_margin_px", PROPERTY_HINT_RANGE, "0,512,1"), "set_culling_margin_px", "get_culling_margin_px");
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "render_focus", PROPERTY_HINT_RANGE, "0,10,0.1"), "set_render_focus", "get_render_focus");
     
     ADD_SIGNAL(MethodInfo("animation_finished"));
     ADD_SIGNAL(MethodInfo("frame_changed", PropertyInfo(Variant::FLOAT, "frame")));
     ADD_SIGNAL(MethodInfo("animation_loaded", PropertyInfo(Variant::BOOL, "success")));
+    ADD_SIGNAL(MethodInfo("bake_progress", PropertyInfo(Variant::INT, "done"), PropertyInfo(Variant::INT, "total")));
+    ADD_SIGNAL(MethodInfo("bake_completed", PropertyInfo(Variant::INT, "frames")));
+    ADD_SIGNAL(MethodInfo("atlas_baked", PropertyInfo(Variant::BOOL, "success")));
 }
 
 LottieAnimation::LottieAnimation() {
@@ -714,8 +705,14 @@ LottieAnimation::LottieAnimation() {
 }
 
 LottieAnimation::~LottieAnimation() {
+    if (schedule_requested) LottieRenderScheduler::get_singleton()->withdraw(this);
+    cancel_bake();
+    _cancel_atlas_bake();
+    _shared_leave_group();
     // Decrement usage for current animation key
     if (!animation_key.is_empty()) _registry_dec(animation_key);
+    if (placeholder_item.is_valid()) RenderingServer::get_singleton()->free_rid(placeholder_item);
+    _free_rd_target();
     _cleanup_thorvg();
 }
 
@@ -723,13 +720,11 @@ void LottieAnimation::_initialize_thorvg() {
     static bool thorvg_initialized = false;
     if (!thorvg_initialized) {
         unsigned int hw_threads = std::thread::hardware_concurrency();
-        unsigned int threads = hw_threads;
-        
-        if (threads == 0) threads = 4;
-        
-        if (hw_threads >= 8) {
-            threads = hw_threads + 2;
-        }
+        int cores = hw_threads == 0 ? 4 : (int)hw_threads;
+        // ThorVG's task threads take the cores the shared LottieRenderPool leaves free, so the
+        // two together stay at the core count.
+        int pool_threads = render_thread_enabled ? LottieRenderPool::configured_thread_count() : 0;
+        unsigned int threads = (unsigned int)std::max(1, cores - pool_threads);
         
         UtilityFunctions::print("Initializing ThorVG with ", threads, " threads (CPU cores: ", hw_threads, ")");
         
@@ -739,6 +734,7 @@ void LottieAnimation::_initialize_thorvg() {
         }
         
         UtilityFunctions::print("ThorVG initialized successfully! Active threads:", threads);
+        UtilityFunctions::print("Lottie pixel kernels: ", LottiePixelOps::get_isa_name());
         thorvg_initialized = true;
     }
     
@@ -752,8 +748,7 @@ void LottieAnimation::_initialize_thorvg() {
     }
     
     _allocate_buffer_and_target(render_size);
-    // Only start worker when enabled (never on Web by default)
-    _start_worker_if_needed();
+    // Worker jobs are dispatched lazily to the shared render pool on the first post.
 }
 
 void LottieAnimation::_cleanup_thorvg() {
@@ -783,24 +778,23 @@ bool LottieAnimation::_load_animation(const String& path) {
         return false;
     }
     
-    if (picture) {
-    canvas->remove();
-        picture = nullptr;
-        animation = nullptr;
-        if (buffer) memset(buffer, 0, (size_t)render_size.x * (size_t)render_size.y * sizeof(uint32_t));
-        if (image.is_valid()) {
-            pixel_bytes.fill(0);
-            image->set_data(render_size.x, render_size.y, false, Image::FORMAT_RGBA8, pixel_bytes);
-            if (texture.is_valid()) texture->update(image);
+    async_job.reset(); // a newer load supersedes one still in flight
+    _unload_current_animation();
+
+    if (async_load) {
+        std::shared_ptr<AsyncLoadJob> job = std::make_shared<AsyncLoadJob>();
+        job->path = path;
+        job->animation_id = active_animation_id;
+        job->selected_animation = selected_dotlottie_animation;
+        async_job = job;
+        if (!render_thread_enabled) {
+            // No threads (web): parse now, but still adopt the result on the next _process().
+            _run_async_load(*job);
+        } else {
+            LottieRenderPool::get_singleton()->submit(job.get(), [job]() { _run_async_load(*job); });
         }
-    }
-    
-    animation = tvg::Animation::gen();
-    picture = animation->picture();
-    
-    if (!picture) {
-        UtilityFunctions::printerr("Failed to create ThorVG picture");
-        return false;
+        queue_redraw(); // show the placeholder
+        return true;
     }
     
     // Load the Lottie file (.json/.lot) or handle .lottie (zip) by extracting the JSON
@@ -810,11 +804,13 @@ bool LottieAnimation::_load_animation(const String& path) {
         // Parse manifest to populate inspector dropdowns
         _parse_dotlottie_manifest(path);
         // Prefer mapped inner JSON path for the active animation id if present
-        String preferred_inner;
-        if (!active_animation_id.is_empty() && sm_anim_inner_paths.has(active_animation_id)) {
-            preferred_inner = (String)sm_anim_inner_paths[active_animation_id];
-        } else {
-            preferred_inner = selected_dotlottie_animation;
+        String preferred_inner = dotlottie_manifest->get_inner_path(active_animation_id);
+        if (preferred_inner.is_empty()) preferred_inner = selected_dotlottie_animation;
+        // Parse straight from the archive when nothing in the bundle has to exist on disk.
+        PackedByteArray json;
+        String entry_key;
+        if (_read_lottie_json_from_zip(path, preferred_inner, json, entry_key)) {
+            return _finish_load(entry_key, nullptr, json);
         }
         // If a specific animation was selected from manifest, prefer extracting that entry
         String extracted = _extract_lottie_json_to_cache(path, preferred_inner);
@@ -824,15 +820,73 @@ bool LottieAnimation::_load_animation(const String& path) {
         }
         source_path = extracted;
     }
+    return _finish_load(source_path, nullptr);
+}
+
+void LottieAnimation::_unload_current_animation() {
+    if (_has_animation()) {
+        if (picture) canvas->remove();
+        picture = nullptr;
+        animation = nullptr;
+        worker_picture_loaded = false;
+        marker_index.reset();
+        if (buffer) memset(buffer, 0, (size_t)render_size.x * (size_t)render_size.y * sizeof(uint32_t));
+        if (image.is_valid()) {
+            pixel_bytes.fill(0);
+            image->set_data(render_size.x, render_size.y, false, Image::FORMAT_RGBA8, pixel_bytes);
+            _recycle_uploaded_buffer(PackedByteArray(), false);
+            shown_frame_id = 0;
+            if (texture.is_valid() && texture.ptr() == rd_texture.ptr()) {
+                _rd_upload(pixel_bytes, Rect2i());
+            } else {
+                Ref<ImageTexture> shown = texture;
+                if (shown.is_valid()) shown->update(image);
+            }
+        }
+    }
+}
+
+// Installs the animation parsed from source_path, either by parsing it now or, for async
+// loads, by adopting the picture `parsed` already holds.
+bool LottieAnimation::_finish_load(const String &source_path, AsyncLoadJob *parsed, const PackedByteArray &json) {
+    const bool worker_owned = _worker_owns_picture();
+    WorkerLoadReply reply;
+    loaded_json = json;
+    if (parsed) {
+        if (worker_owned) {
+            // The worker takes the parsed picture as is; no second parse and no wait.
+            reply.ok = true;
+            reply.duration = parsed->duration;
+            reply.total_frames = parsed->total_frames;
+            reply.width = parsed->width;
+            reply.height = parsed->height;
+            _post_load_to_worker(String::utf8(parsed->path8.c_str()), parsed->animation);
+        } else {
+            animation = parsed->animation;
+            picture = animation->picture();
+        }
+        parsed->animation = nullptr;
+        loaded_path8 = parsed->path8;
+    } else if (!worker_owned) {
+        animation = tvg::Animation::gen();
+        picture = animation->picture();
+        if (!picture) {
+            UtilityFunctions::printerr("Failed to create ThorVG picture");
+            return false;
+        }
+    }
 
     // Try direct load; if it fails (e.g., file is inside the PCK on Web), mirror to user:// and retry.
+    // With a worker-owned picture the JSON is parsed once and the picture moves to the worker.
     auto _try_load_path = [&](const String &p) -> bool {
         String ap = ProjectSettings::get_singleton()->globalize_path(p);
-        return picture->load(ap.utf8().get_data()) == tvg::Result::Success;
+        bool ok = worker_owned ? _load_for_worker(p, json, reply) : _load_picture(picture, ap.utf8().get_data(), json);
+        if (ok) loaded_path8 = ap.utf8().get_data();
+        return ok;
     };
 
-    bool loaded_ok = _try_load_path(source_path);
-    if (!loaded_ok) {
+    bool loaded_ok = parsed != nullptr || _try_load_path(source_path);
+    if (!loaded_ok && json.is_empty()) {
         String mirrored = _mirror_file_to_user_cache(source_path);
         if (!mirrored.is_empty()) {
             loaded_ok = _try_load_path(mirrored);
@@ -842,22 +896,43 @@ bool LottieAnimation::_load_animation(const String& path) {
         UtilityFunctions::printerr("Failed to load Lottie animation: " + source_path);
         return false;
     }
+    worker_picture_loaded = worker_owned;
     // Decrement usage for old key if different
     if (!animation_key.is_empty() && animation_key != source_path) {
         _registry_dec(animation_key);
     }
     animation_key = source_path; // cache key base
+    marker_index = (parsed && parsed->markers) ? parsed->markers : _index_markers(source_path, json);
+    // Cached pixels depend on the post-processing, so each variant is cached under its own id.
+    const String pixel_variant = premultiplied_alpha ? String("#pm") : String(unpremultiply_alpha ? "#u" : "") + String(fix_alpha_border ? "#b" : "");
+    cache_anim_id = LottieFrameCache::get_singleton()->intern(animation_key + pixel_variant);
+    if (LottieFrameCache::get_singleton()->is_disk_enabled()) {
+        // Disk entries outlive the path, so key them by content and pixel post-processing.
+        String content_hash = json.is_empty() ? FileAccess::get_md5(source_path) : json.get_string_from_utf8().md5_text();
+        if (!content_hash.is_empty()) {
+            content_hash += pixel_variant.replace("#", "");
+            LottieFrameCache::get_singleton()->set_content_hash(cache_anim_id, content_hash);
+        }
+    }
     _registry_inc(animation_key);
     _recompute_live_cache_state();
     
     // Get animation info
-    duration = animation->duration();
-    total_frames = animation->totalFrame();
+    float pw = 0.0f, ph = 0.0f;
+    if (worker_owned) {
+        duration = reply.duration;
+        total_frames = reply.total_frames;
+        pw = reply.width;
+        ph = reply.height;
+    } else {
+        duration = animation->duration();
+        total_frames = animation->totalFrame();
+        picture->size(&pw, &ph);
+    }
     current_frame = 0.0f;
+    segment_active = false;
     
     // Query intrinsic size and set sizing policy
-    float pw = 0.0f, ph = 0.0f;
-    picture->size(&pw, &ph);
     if (pw <= 0 || ph <= 0) {
         pw = (float)render_size.x; ph = (float)render_size.y;
     }
@@ -867,14 +942,14 @@ bool LottieAnimation::_load_animation(const String& path) {
     _apply_picture_transform_to_fit();
 
     // Add to canvas once; keep persistent for incremental updates
-    if (canvas->push(picture) != tvg::Result::Success) {
+    if (!worker_owned && canvas->push(picture) != tvg::Result::Success) {
         UtilityFunctions::printerr("Failed to push picture to canvas");
         return false;
     }
     
     _create_texture();
     if (render_thread_enabled) {
-        _post_load_to_worker(source_path);
+        if (!worker_owned) _post_load_to_worker(source_path);
         _post_render_to_worker(render_size, current_frame);
     } else {
         _render_frame(); // Draw initial frame immediately
@@ -893,7 +968,94 @@ bool LottieAnimation::_load_animation(const String& path) {
     return true;
 }
 
+bool LottieAnimation::_load_for_worker(const String &path, const PackedByteArray &json, WorkerLoadReply &r_reply) {
+    // Parse on the calling thread and hand the picture over, as async loads do; waiting for the
+    // worker would queue this load behind every other node's render jobs in the shared pool.
+    String absolute_path = ProjectSettings::get_singleton()->globalize_path(path);
+    tvg::Animation *anim = tvg::Animation::gen();
+    tvg::Picture *pic = anim ? anim->picture() : nullptr;
+    if (!pic || !_load_picture(pic, absolute_path.utf8().get_data(), json)) {
+        delete anim;
+        return false;
+    }
+    r_reply = WorkerLoadReply();
+    r_reply.ok = true;
+    r_reply.duration = anim->duration();
+    r_reply.total_frames = anim->totalFrame();
+    pic->size(&r_reply.width, &r_reply.height);
+    _post_load_to_worker(path, anim);
+    return true;
+}
+
+LottieAnimation::AsyncLoadJob::~AsyncLoadJob() {
+    delete animation; // parsed but never adopted
+}
+
+void LottieAnimation::_run_async_load(AsyncLoadJob &job) {
+    String source_path = job.path;
+    if (job.path.to_lower().ends_with(".lottie")) {
+        job.is_dotlottie = true;
+        job.archive = LottieArchive::open(job.path);
+        job.manifest = LottieManifest::load(job.path);
+        // Same entry choice as the synchronous path after the manifest is applied.
+        String id = job.animation_id;
+        if (id.is_empty() && !job.manifest->get_animation_ids().empty()) id = job.manifest->get_animation_ids()[0];
+        String preferred_inner = job.manifest->get_inner_path(id);
+        if (preferred_inner.is_empty()) preferred_inner = job.selected_animation;
+        if (!_read_lottie_json_from_zip(job.path, preferred_inner, job.json, source_path)) {
+            source_path = _extract_lottie_json_to_cache(job.path, preferred_inner);
+        }
+        if (source_path.is_empty()) {
+            job.done.store(true, std::memory_order_release);
+            return;
+        }
+    }
+    job.source_path = source_path;
+
+    tvg::Animation *anim = tvg::Animation::gen();
+    tvg::Picture *pic = anim ? anim->picture() : nullptr;
+    auto try_load = [&](const String &p) -> bool {
+        String ap = ProjectSettings::get_singleton()->globalize_path(p);
+        if (!_load_picture(pic, ap.utf8().get_data(), job.json)) return false;
+        job.path8 = ap.utf8().get_data();
+        return true;
+    };
+    bool ok = pic && try_load(source_path);
+    if (pic && !ok && job.json.is_empty()) {
+        String mirrored = _mirror_file_to_user_cache(source_path);
+        if (!mirrored.is_empty()) ok = try_load(mirrored);
+    }
+    if (ok) {
+        job.duration = anim->duration();
+        job.total_frames = anim->totalFrame();
+        pic->size(&job.width, &job.height);
+        job.markers = _index_markers(source_path, job.json);
+        job.animation = anim;
+        job.ok = true;
+    } else {
+        delete anim;
+    }
+    job.done.store(true, std::memory_order_release);
+}
+
+void LottieAnimation::_poll_async_load() {
+    if (!async_job || !async_job->done.load(std::memory_order_acquire)) return;
+    std::shared_ptr<AsyncLoadJob> job = async_job;
+    async_job.reset();
+    queue_redraw(); // drop the placeholder
+    if (job->is_dotlottie) _apply_dotlottie_manifest(job->path, job->manifest, job->archive);
+    if (!job->ok) {
+        UtilityFunctions::printerr("Failed to load Lottie animation: " + job->path);
+        emit_signal("animation_loaded", false);
+        return;
+    }
+    if (!_finish_load(job->source_path, job.get(), job->json)) {
+        emit_signal("animation_loaded", false);
+    }
+}
+
 void LottieAnimation::_create_texture() {
+    shown_frame_id = 0;
     image = Image::create(render_size.x, render_size.y, false, Image::FORMAT_RGBA8);
     // Initialize to transparent to avoid white flash during rapid resizes before first frame upload
     if (image.is_valid()) {
@@ -904,6 +1066,11 @@ void LottieAnimation::_create_texture() {
 
 void LottieAnimation::_recreate_texture_ring() {
     texture_ring.clear();
+    _free_rd_target();
+    if (_create_rd_target()) {
+        texture = rd_texture;
+        return;
+    }
     texture_ring.reserve(std::max(2, texture_ring_size));
     for (int i = 0; i < std::max(2, texture_ring_size); ++i) {
         Ref<ImageTexture> tex = ImageTexture::create_from_image(image);
@@ -914,20 +1081,29 @@ void LottieAnimation::_recreate_texture_ring() {
 }
 
 void LottieAnimation::_update_animation(float delta) {
-    if (!playing || !animation || total_frames <= 0) {
+    if (!playing || !_has_animation() || total_frames <= 0) {
         return;
     }
     
     // Update current frame
     float prev_frame = current_frame;
     current_frame += (total_frames / duration) * delta * speed;
-    
+
+    // An atlas baked from a marker only holds that range, so playback loops (or ends) inside it.
+    float range_begin = 0.0f;
+    float range_end = total_frames;
+    if (_atlas_active()) {
+        range_begin = atlas_first_frame;
+        range_end = atlas_last_frame + 1.0f;
+        if (current_frame < range_begin) current_frame = range_begin;
+    }
+
     // Handle looping
-    if (current_frame >= total_frames) {
+    if (current_frame >= range_end) {
         if (looping) {
-            current_frame = fmod(current_frame, total_frames);
+            current_frame = range_begin + fmod(current_frame - range_begin, range_end - range_begin);
         } else {
-            current_frame = total_frames - 1;
+            current_frame = range_end - 1;
             playing = false;
             emit_signal("animation_finished");
         }
@@ -947,6 +1123,13 @@ void LottieAnimation::_render_frame() {
     rendering = true;
     struct _RenderResetGuard { bool *flag; ~_RenderResetGuard(){ if (flag) *flag = false; } } _guard{ &rendering };
 
+    if (worker_picture_loaded) {
+        // The worker holds the only picture: request the frame, _process() uploads it when ready.
+        _post_render_to_worker(render_size, current_frame);
+        last_posted_size = render_size;
+        last_posted_qf = _quantized_frame_index();
+        return;
+    }
     if (!canvas || !animation || !picture || !buffer) {
         return;
     }
@@ -955,14 +1138,17 @@ void LottieAnimation::_render_frame() {
     if (first_frame_drawn && !pending_resize && qf_now == last_rendered_qf) {
         return;
     }
-    // Cache fast-path: if enabled, try to reuse a shared texture
-    if (frame_cache_enabled && (!cache_only_when_paused || !playing ? true : false)) {
+    // Cache fast-path: if enabled, upload shared pixels instead of rasterizing
+    const bool use_cache = _frame_cache_usable();
+    if (use_cache) {
         _ensure_cache_capacity();
-        int qf = _quantized_frame_index();
-        Ref<ImageTexture> cached = LottieFrameCache::get_singleton()->get(animation_key, qf, render_size);
-        if (cached.is_valid()) {
-            texture = cached;
-            _uploaded_this_frame = true; // visual changed
+        PackedByteArray cached;
+        bool owned = false;
+        if (image.is_valid() && LottieFrameCache::get_singleton()->get(cache_anim_id, qf_now, render_size, cached, &owned)) {
+            // main_diff stays valid: it describes the last rasterized frame, which a hit does not touch.
+            _upload_rgba(cached, owned, qf_now);
+            last_rendered_qf = qf_now;
+            first_frame_drawn = true;
             return;
         }
     }
@@ -974,35 +1160,26 @@ void LottieAnimation::_render_frame() {
     canvas->draw(false);
     canvas->sync();
     
-    // Copy buffer to image (reuse persistent pixel_bytes to avoid allocations)
+    // Convert into a pooled buffer; the image shares it until the next frame replaces it.
     if (image.is_valid()) {
-        const int64_t bytes_needed = (int64_t)render_size.x * (int64_t)render_size.y * 4;
-        if (pixel_bytes.size() != bytes_needed) {
-            pixel_bytes.resize(bytes_needed);
-        }
-        // Optimized conversion ARGB -> RGBA into persistent pixel_bytes.
-        _convert_argb_to_rgba_optimized(buffer, pixel_bytes.ptrw(), (size_t)render_size.x * (size_t)render_size.y);
-        if (unpremultiply_alpha) {
-            _unpremultiply_alpha_rgba(pixel_bytes.ptrw(), render_size.x, render_size.y);
-        }
-        if (fix_alpha_border) {
-            _fix_alpha_border_rgba(pixel_bytes.ptrw(), render_size.x, render_size.y);
-        }
-        image->set_data(render_size.x, render_size.y, false, Image::FORMAT_RGBA8, pixel_bytes);
-        if (!texture_ring.empty()) {
-            Ref<ImageTexture> &slot = texture_ring[texture_ring_index];
-            if (slot.is_valid()) {
-                slot->update(image);
-                texture = slot;
-                texture_ring_index = (texture_ring_index + 1) % (int)texture_ring.size();
+        Rect2i dirty;
+        if (!main_diff.update(buffer, render_size.x, render_size.y, unpremultiply_alpha, fix_alpha_border, premultiplied_alpha, dirty)) {
+            // Pixel-identical to the last rasterized frame: skip conversion, and the upload too if it is on screen.
+            if (shown_frame_id != MAIN_DIFF_FRAME || shared_group != 0) {
+                _upload_rgba(main_diff.rgba, false, qf_now);
+                shown_frame_id = MAIN_DIFF_FRAME;
             }
-        } else if (texture.is_valid()) {
-            texture->update(image);
-        }
-        // Store in cache if enabled
-        if (frame_cache_enabled && (!cache_only_when_paused || !playing ? true : false)) {
-            int qf = _quantized_frame_index();
-            LottieFrameCache::get_singleton()->put(animation_key, qf, render_size, texture, (size_t)bytes_needed);
+        } else {
+            Rect2i changed;
+            PackedByteArray frame_rgba = main_diff.produce(buffer, dirty, changed);
+            // The rect is relative to the previous rasterized frame, so it only helps while that is shown.
+            if (shown_frame_id != MAIN_DIFF_FRAME) changed = Rect2i();
+            // Store in cache if enabled; the cache then shares the buffer, so it is not recycled.
+            if (use_cache) {
+                LottieFrameCache::get_singleton()->put(cache_anim_id, qf_now, render_size, frame_rgba);
+            }
+            _upload_rgba(frame_rgba, !use_cache, qf_now, changed);
+            shown_frame_id = MAIN_DIFF_FRAME;
         }
     }
     last_rendered_qf = qf_now;
@@ -1016,12 +1193,151 @@ int LottieAnimation::_quantized_frame_index() const {
     return (idx / step) * step;
 }
 
+void LottieAnimation::_upload_rgba(const PackedByteArray &rgba, bool recyclable, int qf, const Rect2i &changed) {
+    shown_frame_id = 0; // callers that know the frame's identity set it afterwards
+    // Ensure image/texture prepared for this size
+    if (!image.is_valid() || image->get_width() != render_size.x || image->get_height() != render_size.y) {
+        _create_texture();
+    }
+    // Image shares the buffer (copy-on-write), so only the GPU upload copies pixels.
+    image->set_data(render_size.x, render_size.y, false, Image::FORMAT_RGBA8, rgba);
+    _recycle_uploaded_buffer(rgba, recyclable);
+    if (_shared_publish(qf)) {
+        // Uploaded into a shared slot instead of this node's ring.
+    } else if (_rd_upload(rgba, changed)) {
+        texture = rd_texture;
+    } else if (!texture_ring.empty()) {
+        Ref<ImageTexture> &slot = texture_ring[texture_ring_index];
+        if (slot.is_valid()) {
+            slot->update(image);
+            texture = slot;
+            texture_ring_index = (texture_ring_index + 1) % (int)texture_ring.size();
+        }
+    }
+    _uploaded_this_frame = true; // visual changed
+}
+
+bool LottieAnimation::_create_rd_target() {
+    RenderingServer *rs = RenderingServer::get_singleton();
+    RenderingDevice *rd = rs->get_rendering_device();
+    // RenderingDevice calls are only made here on the main thread, so a threaded renderer keeps the ring.
+    if (!rd || !rs->is_on_render_thread() || !image.is_valid()) return false;
+    Ref<RDTextureFormat> format;
+    format.instantiate();
+    format->set_width(render_size.x);
+    format->set_height(render_size.y);
+    format->set_format(RenderingDevice::DATA_FORMAT_R8G8B8A8_UNORM);
+    format->set_usage_bits(RenderingDevice::TEXTURE_USAGE_SAMPLING_BIT | RenderingDevice::TEXTURE_USAGE_CAN_UPDATE_BIT | RenderingDevice::TEXTURE_USAGE_CAN_COPY_TO_BIT);
+    Ref<RDTextureView> view;
+    view.instantiate();
+    TypedArray<PackedByteArray> data;
+    data.push_back(image->get_data());
+    rd_target = rd->texture_create(format, view, data);
+    if (!rd_target.is_valid()) return false;
+    rd_texture.instantiate();
+    rd_texture->set_texture_rd_rid(rd_target);
+    return true;
+}
+
+void LottieAnimation::_free_rd_target() {
+    if (rd_texture.is_valid() && texture.ptr() == rd_texture.ptr()) texture.unref();
+    rd_texture.unref();
+    RenderingServer *rs = RenderingServer::get_singleton();
+    RenderingDevice *rd = rs ? rs->get_rendering_device() : nullptr;
+    if (rd) {
+        if (rd_staging.is_valid()) rd->free_rid(rd_staging);
+        if (rd_target.is_valid()) rd->free_rid(rd_target);
+    }
+    rd_staging = RID();
+    rd_target = RID();
+    rd_staging_size = Vector2i();
+    rd_staging_bytes = PackedByteArray();
+}
+
+bool LottieAnimation::_rd_upload(const PackedByteArray &rgba, const Rect2i &changed) {
+    if (!rd_target.is_valid()) return false;
+    RenderingDevice *rd = RenderingServer::get_singleton()->get_rendering_device();
+    // The rect is relative to what rd_texture shows, so it only applies while it is on screen.
+    const bool patch = changed.has_area() && texture.ptr() == rd_texture.ptr();
+    const Vector2i staging = patch ? Vector2i(
+            std::min(render_size.x, (changed.size.x + RD_STAGING_STEP - 1) / RD_STAGING_STEP * RD_STAGING_STEP),
+            std::min(render_size.y, (changed.size.y + RD_STAGING_STEP - 1) / RD_STAGING_STEP * RD_STAGING_STEP))
+            : render_size;
+    if (staging == render_size) {
+        rd->texture_update(rd_target, 0, rgba);
+        return true;
+    }
+    if (staging != rd_staging_size) {
+        // Recreated only when the rounded size changes, which a moving shape rarely does.
+        if (rd_staging.is_valid()) rd->free_rid(rd_staging);
+        Ref<RDTextureFormat> format;
+        format.instantiate();
+        format->set_width(staging.x);
+        format->set_height(staging.y);
+        format->set_format(RenderingDevice::DATA_FORMAT_R8G8B8A8_UNORM);
+        format->set_usage_bits(RenderingDevice::TEXTURE_USAGE_CAN_UPDATE_BIT | RenderingDevice::TEXTURE_USAGE_CAN_COPY_FROM_BIT);
+        Ref<RDTextureView> view;
+        view.instantiate();
+        rd_staging = rd->texture_create(format, view);
+        rd_staging_size = rd_staging.is_valid() ? staging : Vector2i();
+        rd_staging_bytes.resize((int64_t)staging.x * (int64_t)staging.y * 4);
+        if (!rd_staging.is_valid()) {
+            rd->texture_update(rd_target, 0, rgba);
+            return true;
+        }
+    }
+    // Pack the changed rows into the top-left corner of the staging texture, then copy just
+    // that rect into place on the GPU.
+    const size_t src_pitch = (size_t)render_size.x * 4;
+    const size_t dst_pitch = (size_t)staging.x * 4;
+    const uint8_t *src = rgba.ptr() + (size_t)changed.position.y * src_pitch + (size_t)changed.position.x * 4;
+    uint8_t *dst = rd_staging_bytes.ptrw();
+    for (int y = 0; y < changed.size.y; ++y) {
+        memcpy(dst + (size_t)y * dst_pitch, src + (size_t)y * src_pitch, (size_t)changed.size.x * 4);
+    }
+    rd->texture_update(rd_staging, 0, rd_staging_bytes);
+    rd->texture_copy(rd_staging, rd_target, Vector3(), Vector3((float)changed.position.x, (float)changed.position.y, 0.0f),
+            Vector3((float)changed.size.x, (float)changed.size.y, 1.0f), 0, 0, 0, 0);
+    return true;
+}
+
+void LottieAnimation::_recycle_uploaded_buffer(const PackedByteArray &now_uploaded, bool recyclable) {
+    // The image just replaced its data with now_uploaded, so the previous buffer can go back to
+    // the pool unless it is uploaded again or a frame diff still holds it. Buffers shared with
+    // the frame cache are only dropped.
+    if (uploaded_recyclable && uploaded_rgba.ptr() != now_uploaded.ptr()) {
+        _release_frame_buffer(uploaded_rgba);
+    }
+    uploaded_rgba = now_uploaded;
+    uploaded_recyclable = recyclable;
+}
+
+bool LottieAnimation::_frame_buffer_retained(const PackedByteArray &rgba) const {
+    const uint8_t *p = rgba.ptr();
+    return p != nullptr && (p == main_diff.rgba.ptr() || p == main_diff.back.ptr() || p == w_diff_rgba_ptr.load(std::memory_order_acquire) || p == w_diff_back_ptr.load(std::memory_order_acquire));
+}
+
+void LottieAnimation::_release_frame_buffer(PackedByteArray &rgba) {
+    // Main thread only. The worker only ever takes on fresh buffers (pooled, or copies of shared
+    // ones), so a buffer it is not holding now cannot become retained again.
+    if (!_frame_buffer_retained(rgba)) LottieFrameBufferPool::get_singleton()->release(rgba);
+}
+
+bool LottieAnimation::_frame_cache_usable() const {
+    return frame_cache_enabled && (!cache_only_when_paused || !playing) && cache_anim_id != 0;
+}
+
+int64_t LottieAnimation::get_frame_buffer_allocations() {
+    return (int64_t)LottieFrameBufferPool::get_singleton()->get_allocation_count();
+}
+
 void LottieAnimation::_ensure_cache_capacity() {
     size_t bytes = (size_t)std::max(16, frame_cache_budget_mb) * 1024ull * 1024ull;
     LottieFrameCache::get_singleton()->set_capacity_bytes(bytes);
 }
 
 void LottieAnimation::_ready() {
+    _apply_premultiplied_material();
     // Process also in the editor to react to editor zoom.
     set_process_mode(Node::PROCESS_MODE_ALWAYS);
     set_process(true);
@@ -1043,6 +1359,10 @@ void LottieAnimation::_ready() {
 
 void LottieAnimation::_process(double delta) {
     _uploaded_this_frame = false; // reset per-frame flag for redraw gating
+    _poll_bake_progress();
+    _poll_atlas_bake();
+    _poll_async_load();
+    if (_is_async_loading()) return; // nothing to render until the load lands
     // Coalesce pending resizes safely here, once per frame
     _elapsed_time += delta;
     if (dynamic_resolution) {
@@ -1063,62 +1383,84 @@ void LottieAnimation::_process(double delta) {
         }
     }
     _update_animation(delta);
+    if (_atlas_active()) {
+        // Sprite-sheet playback: no rasterization, just pick the baked cell.
+        int idx = _atlas_index_for_frame(current_frame);
+        if (idx != atlas_drawn_index) queue_redraw();
+        return;
+    }
     if (is_visible_in_tree() || Engine::get_singleton()->is_editor_hint()) {
-        // Culling disabled: always treat as visible and post/refresh on frame/size change
-        bool on_screen_now = true;
-        bool became_visible = false;
-        if (render_thread_enabled) {
+        // Off-screen nodes keep advancing their clock but post no render jobs and upload
+        // nothing; the editor never culls.
+        bool on_screen_now = Engine::get_singleton()->is_editor_hint() || _is_visible_on_screen();
+        bool became_visible = on_screen_now && !last_visible_on_screen;
+        last_visible_on_screen = on_screen_now;
+        if (became_visible) {
+            // Whatever was posted or drawn before going off-screen is stale.
+            last_posted_qf = -1;
+            last_rendered_qf = -1;
+        }
+        _shared_sync_group();
+        if (!on_screen_now) {
+            // Culled
+        } else if (shared_group != 0 && _shared_try_borrow(_quantized_frame_index())) {
+            // Another instance already uploaded this frame at this size.
+        } else if (render_thread_enabled) {
             // Ask worker to render the next desired frame
             {
+                if (_frame_cache_usable()) _ensure_cache_capacity();
                 int qf = _quantized_frame_index();
-                if (render_size != last_posted_size || qf != last_posted_qf) {
-                    _post_render_to_worker(render_size, current_frame);
-                    last_posted_size = render_size;
-                    last_posted_qf = qf;
+                if ((render_size != last_posted_size || qf != last_posted_qf) && !_shared_pending_elsewhere(qf)) {
+                    _request_render();
                 }
             }
-            // Try to upload the most recent finished frame
+            // Take ownership of the most recent finished frame; the lock only guards the handoff.
+            PackedByteArray frame_rgba;
+            bool have_frame = false;
+            bool frame_recyclable = false;
+            int frame_qf = -1;
+            uint64_t frame_id = 0;
+            uint64_t frame_same_as = 0;
+            Rect2i frame_changed;
             {
                 std::lock_guard<std::mutex> lk(frame_mutex);
                 if (latest_frame.ready && latest_frame.id > last_consumed_id) {
                     if (latest_frame.w == render_size.x && latest_frame.h == render_size.y) {
-                        // Ensure image/texture prepared for this size
-                        if (!image.is_valid() || image->get_width() != render_size.x || image->get_height() != render_size.y) {
-                            _create_texture();
-                        }
-                        PackedByteArray pba;
-                        pba.resize((int64_t)latest_frame.rgba.size());
-                        {
-                            uint8_t *dst = pba.ptrw();
-                            memcpy(dst, latest_frame.rgba.data(), latest_frame.rgba.size());
-                        }
-                        image->set_data(render_size.x, render_size.y, false, Image::FORMAT_RGBA8, pba);
-                        if (!texture_ring.empty()) {
-                            Ref<ImageTexture> &slot = texture_ring[texture_ring_index];
-                            if (slot.is_valid()) {
-                                slot->update(image);
-                                texture = slot;
-                                texture_ring_index = (texture_ring_index + 1) % (int)texture_ring.size();
-                            }
-                        } else if (texture.is_valid()) {
-                            texture->update(image);
-                        }
+                        frame_rgba = latest_frame.rgba;
+                        frame_recyclable = latest_frame.recyclable;
+                        frame_qf = latest_frame.qf;
+                        frame_id = latest_frame.id;
+                        frame_same_as = latest_frame.same_as_id;
+                        // A patch only applies on top of the frame it was diffed against.
+                        if (latest_frame.base_id != 0 && latest_frame.base_id == shown_frame_id) frame_changed = latest_frame.changed;
                         last_consumed_id = latest_frame.id;
-                        latest_frame.ready = false;
-                        _uploaded_this_frame = true; // visual changed
-                    } else {
-                        // Size changed; drop this frame
-                        latest_frame.ready = false;
+                        have_frame = true;
                     }
+                    // Size mismatches are dropped
+                    PackedByteArray dropped = latest_frame.rgba;
+                    latest_frame.rgba = PackedByteArray();
+                    latest_frame.ready = false;
+                    if (!have_frame && latest_frame.recyclable) _release_frame_buffer(dropped);
                 }
             }
+            if (have_frame && frame_same_as != 0 && frame_same_as == shown_frame_id && shared_group == 0) {
+                // Nothing changed since the frame on screen: no conversion happened, skip the upload too.
+                frame_rgba = PackedByteArray();
+            } else if (have_frame) {
+                _upload_rgba(frame_rgba, frame_recyclable, frame_qf, frame_changed);
+                shown_frame_id = frame_same_as != 0 ? frame_same_as : frame_id;
+                float worker_cost = worker_render_cost_ms.exchange(-1.0f);
+                if (worker_cost >= 0.0f) _note_render_cost(worker_cost);
+            }
         } else {
             // Only render on main thread if frame or size changed
             int qf = _quantized_frame_index();
             if (pending_resize || !first_frame_drawn || qf != last_rendered_qf) {
-                _render_frame();
+                _request_render();
             }
         }
+    } else {
+        last_visible_on_screen = false; // hidden nodes refresh like culled ones when shown again
     }
     // Redraw gating: redraw only when visuals changed or after applying resize
     if (_uploaded_this_frame || applied_resize) {
@@ -1127,7 +1469,31 @@ void LottieAnimation::_process(double delta) {
     }
 }
 
+void LottieAnimation::_draw_placeholder() {
+    const bool show = _is_async_loading() && placeholder_texture.is_valid();
+    if (!show && !placeholder_item.is_valid()) return;
+    RenderingServer *rs = RenderingServer::get_singleton();
+    if (!placeholder_item.is_valid()) {
+        placeholder_item = rs->canvas_item_create();
+        rs->canvas_item_set_parent(placeholder_item, get_canvas_item());
+    }
+    rs->canvas_item_clear(placeholder_item);
+    if (show) {
+        Vector2 size = Vector2((float)fit_box_size.x, (float)fit_box_size.y);
+        placeholder_texture->draw_rect(placeholder_item, Rect2(-size * 0.5f + offset, size), false);
+    }
+}
+
 void LottieAnimation::_draw() {
+    _draw_placeholder();
+    if (_is_async_loading()) return;
+    if (_atlas_active()) {
+        atlas_drawn_index = _atlas_index_for_frame(current_frame);
+        const AtlasFrame &af = atlas_frames[atlas_drawn_index];
+        Vector2 size = Vector2((float)fit_box_size.x, (float)fit_box_size.y);
+        draw_texture_rect_region(atlas_textures[af.page], Rect2(-size * 0.5f + offset, size), af.rect);
+        return;
+    }
     if (texture.is_valid()) {
         // Draw at logical display size (fit_box_size), independent of internal render resolution.
         // Apply offset so Node2D position can serve as YSort pivot (e.g. feet) while image draws above it.
@@ -1150,6 +1516,15 @@ void LottieAnimation::_notification(int32_t p_what) {
                 // redraw will be queued in _process when resize applies or a new frame uploads
             }
             break;
+        case NOTIFICATION_ENTER_TREE:
+            // Back in the tree with a bundle loaded: hold its handle again.
+            if (!dotlottie_archive && _has_animation() && animation_path.to_lower().ends_with(".lottie")) {
+                dotlottie_archive = LottieArchive::open(animation_path);
+            }
+            break;
+        case NOTIFICATION_EXIT_TREE:
+            dotlottie_archive.reset();
+            break;
         default:
             break;
     }
@@ -1157,15 +1532,17 @@ void LottieAnimation::_notification(int32_t p_what) {
 
 void LottieAnimation::_allocate_buffer_and_target(const Vector2i &size) {
     if (size.x <= 0 || size.y <= 0) return;
-    Ref<ImageTexture> old_texture = texture;
     Ref<Image> old_image = image;
     Vector2i old_render_size = render_size;
 
     if (buffer) { delete[] buffer; buffer = nullptr; }
     render_size = Vector2i(std::min(size.x, max_render_size.x), std::min(size.y, max_render_size.y));
-    buffer = new uint32_t[(size_t)render_size.x * (size_t)render_size.y];
-    memset(buffer, 0, (size_t)render_size.x * (size_t)render_size.y * sizeof(uint32_t));
-    canvas->target(buffer, render_size.x, render_size.x, render_size.y, tvg::ColorSpace::ARGB8888S);
+    // A worker-owned picture never rasterizes on the main thread, so it needs no main target buffer.
+    if (!_worker_owns_picture()) {
+        buffer = new uint32_t[(size_t)render_size.x * (size_t)render_size.y];
+        memset(buffer, 0, (size_t)render_size.x * (size_t)render_size.y * sizeof(uint32_t));
+        canvas->target(buffer, render_size.x, render_size.x, render_size.y, _target_colorspace(premultiplied_alpha));
+    }
     pixel_bytes.resize((int64_t)render_size.x * (int64_t)render_size.y * 4);
     _create_texture();
 
@@ -1174,14 +1551,15 @@ void LottieAnimation::_allocate_buffer_and_target(const Vector2i &size) {
         Ref<Image> temp = old_image->duplicate();
         if (temp.is_valid()) {
             temp->resize(render_size.x, render_size.y, Image::INTERPOLATE_BILINEAR);
-            if (!texture_ring.empty()) {
+            // Use the scaled previous content until the new frame arrives.
+            if (_rd_upload(temp->get_data(), Rect2i())) {
+                texture = rd_texture;
+            } else if (!texture_ring.empty()) {
                 Ref<ImageTexture> &slot = texture_ring[0];
                 if (slot.is_valid()) {
                     slot->update(temp);
-                    texture = slot; // use scaled previous content until new frame arrives
+                    texture = slot;
                 }
-            } else if (texture.is_valid()) {
-                texture->update(temp);
             }
         }
     }
@@ -1209,48 +1587,40 @@ void LottieAnimation::_apply_picture_transform_to_fit() {
 
 String LottieAnimation::_current_state_segment_marker() const {
     if (active_state.is_empty()) return String();
-    if (sm_state_segments_by_machine.has(active_state_machine)) {
-        Dictionary segs = sm_state_segments_by_machine[active_state_machine];
-        if (segs.has(active_state)) {
-            return (String)segs[active_state];
-        }
-    }
-    return active_state;
+    String segment = dotlottie_manifest->get_state_segment(active_state_machine, active_state);
+    return segment.is_empty() ? active_state : segment;
+}
+
+// FNV-1a over the whole buffer; a plain byte loop is far cheaper than the ThorVG parse it precedes.
+static uint64_t _content_stamp(const PackedByteArray &bytes) {
+    uint64_t h = 0xCBF29CE484222325ull;
+    const uint8_t *p = bytes.ptr();
+    for (int64_t i = 0, n = bytes.size(); i < n; i++) {
+        h = (h ^ p[i]) * 0x100000001B3ull;
+    }
+    return h;
+}
+
+// Indexes the markers of source_path (or of `json` for in-memory loads) unless an index for
+// the same content is already cached. File sources are stamped with their mtime, in-memory
+// ones with a hash of their bytes, so a re-extracted or edited animation is scanned again.
+std::shared_ptr<const LottieMarkerIndex> LottieAnimation::_index_markers(const String &source_path, const PackedByteArray &json) {
+    if (source_path.is_empty()) return nullptr;
+    const uint64_t stamp = json.is_empty() ? FileAccess::get_modified_time(source_path) : _content_stamp(json);
+    std::shared_ptr<const LottieMarkerIndex> index = LottieMarkerIndex::find(source_path, stamp);
+    if (index) return index;
+    if (!json.is_empty()) return LottieMarkerIndex::build(source_path, stamp, json);
+    Ref<FileAccess> f = FileAccess::open(source_path, FileAccess::READ);
+    if (f.is_null()) return nullptr;
+    PackedByteArray data = f->get_buffer(f->get_length());
+    f->close();
+    return LottieMarkerIndex::build(source_path, stamp, data);
 }
 
-bool LottieAnimation::_find_marker_range(const String &json_path, const String &marker, float &out_begin, float &out_end) const {
+bool LottieAnimation::_find_marker_range(const String &marker, float &out_begin, float &out_end) const {
     out_begin = 0.0f; out_end = 0.0f;
-    if (json_path.is_empty() || marker.is_empty()) return false;
-    String abs = ProjectSettings::get_singleton()->globalize_path(json_path);
-    Ref<FileAccess> f = FileAccess::open(abs, FileAccess::READ);
-    if (f.is_null()) return false;
-    PackedByteArray data = f->get_buffer(f->get_length());
-    f->close();
-    String text = data.get_string_from_utf8();
-    Variant v = JSON::parse_string(text);
-    if (v.get_type() != Variant::DICTIONARY) return false;
-    Dictionary d = v;
-    // fr: frame rate; ip/op: in/out points in frames. Markers are in frames as well in many exports.
-    double fr = d.has("fr") ? (double)d["fr"] : 60.0;
-    if (!d.has("markers")) return false;
-    Array markers = d["markers"];
-    for (int i = 0; i < markers.size(); i++) {
-        if (markers[i].get_type() != Variant::DICTIONARY) continue;
-        Dictionary mk = markers[i];
-        String name;
-        if (mk.has("cm")) name = (String)mk["cm"]; // common in Bodymovin
-        else if (mk.has("n")) name = (String)mk["n"]; // alternative key
-        if (name != marker) continue;
-        double tm = 0.0; double dr = 0.0;
-        if (mk.has("tm")) tm = (double)mk["tm"]; // start frame/time
-        if (mk.has("dr")) dr = (double)mk["dr"]; // duration in frames
-        // Some exports may use seconds, but most use frames. We'll assume frames; if total_frames looks small, this still maps.
-        out_begin = (float)tm;
-        out_end = (float)(tm + dr);
-        if (out_end <= out_begin) out_end = out_begin + 1.0f;
-        return true;
-    }
-    return false;
+    if (!marker_index || marker.is_empty()) return false;
+    return marker_index->get_range(marker, out_begin, out_end);
 }
 
 void LottieAnimation::_apply_selected_state_segment() {
@@ -1258,10 +1628,12 @@ void LottieAnimation::_apply_selected_state_segment() {
     if (marker.is_empty()) return;
     // Try to resolve marker to frame range from the loaded JSON and apply range segment
     float sb = 0.0f, se = 0.0f;
-    String json_path = animation_key;
-    if (_find_marker_range(json_path, marker, sb, se)) {
+    if (_find_marker_range(marker, sb, se)) {
         if (animation) animation->segment(sb, se);
         _post_segment_to_worker(sb, se);
+        segment_active = true;
+        segment_begin = sb;
+        segment_end = se;
     }
 }
 
@@ -1324,7 +1696,7 @@ void LottieAnimation::_on_viewport_size_changed() {
 void LottieAnimation::set_use_animation_size(bool p_enable) {
     if (use_animation_size == p_enable) return;
     use_animation_size = p_enable;
-    if (canvas && picture) {
+    if (canvas && _has_animation()) {
         _apply_sizing_policy();
         _apply_picture_transform_to_fit();
     }
@@ -1334,7 +1706,7 @@ bool LottieAnimation::is_using_animation_size() const { return use_animation_siz
 void LottieAnimation::set_fit_into_box(bool p_enable) {
     if (fit_into_box == p_enable) return;
     fit_into_box = p_enable;
-    if (canvas && picture) {
+    if (canvas && _has_animation()) {
         _apply_sizing_policy();
         _apply_picture_transform_to_fit();
     }
@@ -1344,7 +1716,7 @@ bool LottieAnimation::is_fit_into_box() const { return fit_into_box; }
 void LottieAnimation::set_fit_box_size(const Vector2i &p_size) {
     if (fit_box_size == p_size) return;
     fit_box_size = p_size;
-    if (canvas && picture && fit_into_box) {
+    if (canvas && _has_animation() && fit_into_box) {
         _apply_sizing_policy();
         _apply_picture_transform_to_fit();
     }
@@ -1369,7 +1741,7 @@ int LottieAnimation::get_frame_cache_step() const { return frame_cache_step; }
 void LottieAnimation::set_engine_option(int p_opt) { engine_option = (p_opt == 1 ? 1 : 0); }
 int LottieAnimation::get_engine_option() const { return engine_option; }
 void LottieAnimation::render_static() {
-    if (!animation) return;
+    if (!_has_animation()) return;
     if (render_thread_enabled) {
         // Force a one-shot render upload by calling main-thread render (safe, uses current frame)
         _render_frame();
@@ -1386,13 +1758,30 @@ void LottieAnimation::set_live_cache_threshold(int p_threshold) {
 int LottieAnimation::get_live_cache_threshold() const { return live_cache_threshold; }
 void LottieAnimation::set_live_cache_force(bool p_force) { live_cache_force = p_force; _recompute_live_cache_state(); }
 bool LottieAnimation::get_live_cache_force() const { return live_cache_force; }
-void LottieAnimation::set_culling_mode(int p_mode) { /* culling disabled */ }
-int LottieAnimation::get_culling_mode() const { return 2; }
-void LottieAnimation::set_culling_margin_px(float p_margin) { }
-float LottieAnimation::get_culling_margin_px() const { return 0.0f; }
+void LottieAnimation::set_single_picture_owner(bool p_enable) {
+    if (single_picture_owner == p_enable) return;
+    single_picture_owner = p_enable;
+    // The main target buffer only exists without a worker-owned picture, so (re)allocate or drop it.
+    if (canvas) _allocate_buffer_and_target(render_size);
+    // Move picture ownership by reloading.
+    if (is_inside_tree() && !animation_path.is_empty()) {
+        _load_animation(animation_path);
+    }
+}
+bool LottieAnimation::is_single_picture_owner() const { return single_picture_owner; }
+void LottieAnimation::set_culling_mode(int p_mode) {
+    culling_mode = std::clamp(p_mode, 0, 2);
+    last_visible_on_screen = false; // re-evaluate (and refresh) on the next frame
+}
+int LottieAnimation::get_culling_mode() const { return culling_mode; }
+void LottieAnimation::set_culling_margin_px(float p_margin) {
+    culling_margin_px = std::max(0.0f, p_margin);
+    last_visible_on_screen = false;
+}
+float LottieAnimation::get_culling_margin_px() const { return culling_margin_px; }
 
 void LottieAnimation::play() {
-    if (!animation) {
+    if (!_has_animation() && !_is_async_loading()) {
         if (!animation_path.is_empty()) {
             _load_animation(animation_path);
         } else {
@@ -1435,11 +1824,8 @@ void LottieAnimation::set_animation_path(const String& path) {
                 _load_animation(path);
                 // If not a .lottie, clear manifest/state UI
                 if (!animation_path.to_lower().ends_with(".lottie")) {
-                    sm_animation_ids.clear();
-                    sm_machine_names.clear();
-                    sm_states_by_machine.clear();
-                    sm_anim_inner_paths.clear();
-                    sm_state_segments_by_machine.clear();
+                    dotlottie_manifest = LottieManifest::empty();
+                    dotlottie_archive.reset();
                     active_animation_id = String();
                     active_state_machine = String();
                     active_state = String();
@@ -1447,23 +1833,28 @@ void LottieAnimation::set_animation_path(const String& path) {
                 }
             } else {
                 // Clear current animation and visuals when path is removed
+                async_job.reset(); // a load still in flight must not land after the clear
+                dotlottie_archive.reset();
                 playing = false;
                 if (canvas) {
                     canvas->remove();
                 }
                 picture = nullptr;
                 animation = nullptr;
+                worker_picture_loaded = false;
                 // Clear any pending/last worker frame so it won't upload after clearing
                 {
                     std::lock_guard<std::mutex> lk(frame_mutex);
                     latest_frame.ready = false;
-                    latest_frame.rgba.clear();
+                    if (latest_frame.recyclable) _release_frame_buffer(latest_frame.rgba);
+                    latest_frame.rgba = PackedByteArray();
                     last_consumed_id = next_frame_id; // advance cursor
                 }
                 if (buffer) memset(buffer, 0, (size_t)render_size.x * (size_t)render_size.y * sizeof(uint32_t));
                 if (image.is_valid()) {
                     pixel_bytes.fill(0);
                     image->set_data(render_size.x, render_size.y, false, Image::FORMAT_RGBA8, pixel_bytes);
+                    _recycle_uploaded_buffer(PackedByteArray(), false);
                 }
                 // Drop current texture reference so _draw no longer draws anything
                 texture.unref();
@@ -1536,7 +1927,7 @@ void LottieAnimation::set_render_size(const Vector2i& size) {
     if (fit_box_size == size) return;
     fit_box_size = size;
     fit_into_box = true;
-    if (canvas && picture) {
+    if (canvas && _has_animation()) {
         _apply_sizing_policy();
         _apply_picture_transform_to_fit();
     }
@@ -1554,22 +1945,30 @@ float LottieAnimation::get_total_frames() const {
     return total_frames;
 }
 
-void LottieAnimation::_start_worker_if_needed() {
-    if (!render_thread_enabled || render_thread.joinable()) return;
-    worker_stop = false;
-    load_pending = false;
-    render_pending = false;
-    render_thread = std::thread([this]() { _worker_loop(); });
+void LottieAnimation::_schedule_worker_locked() {
+    // Caller holds job_mutex. At most one pool task per node is queued or running.
+    if (job_scheduled) return;
+    job_scheduled = true;
+    LottieRenderPool::get_singleton()->submit(this, [this]() { _worker_run_jobs(); });
 }
 
 void LottieAnimation::_stop_worker() {
-    if (!render_thread.joinable()) return;
+    // Drop pending requests first so an in-flight pass does not requeue itself.
+    {
+        std::lock_guard<std::mutex> lk(job_mutex);
+        load_pending = false;
+        render_pending = false;
+        segment_pending = false;
+        delete pending_adopt_animation;
+        pending_adopt_animation = nullptr;
+    }
+    if (LottieRenderPool::has_singleton()) {
+        LottieRenderPool::get_singleton()->cancel(this);
+    }
     {
         std::lock_guard<std::mutex> lk(job_mutex);
-        worker_stop = true;
+        job_scheduled = false;
     }
-    job_cv.notify_all();
-    render_thread.join();
     _worker_free_resources();
 }
 
@@ -1581,8 +1980,9 @@ bool LottieAnimation::_is_visible_on_screen() const {
     }
     // Build local AABB centered at origin in local space
     const Vector2 half = Vector2((float)fit_box_size.x, (float)fit_box_size.y) * 0.5f;
-    const Rect2 local_rect(-half, Vector2((float)fit_box_size.x, (float)fit_box_size.y));
-    const Transform2D to_canvas = get_global_transform_with_canvas();
+    const Rect2 local_rect(-half + offset, Vector2((float)fit_box_size.x, (float)fit_box_size.y));
+    // CameraWorld compares in world space; ViewportRect in viewport space (canvas transform applied).
+    const Transform2D to_canvas = culling_mode == 1 ? get_global_transform() : get_global_transform_with_canvas();
 
     // Compute bounding in world/canvas space
     Vector2 c[4];
@@ -1610,23 +2010,10 @@ bool LottieAnimation::_is_visible_on_screen() const {
         for (int i=1;i<4;i++){ minx = MIN(minx, wc[i].x); maxx = MAX(maxx, wc[i].x); miny = MIN(miny, wc[i].y); maxy = MAX(maxy, wc[i].y);} 
         visible_world = Rect2(Vector2(minx, miny), Vector2(maxx - minx, maxy - miny));
     } else {
-        // ViewportRect: transform world_bb to screen and intersect with viewport rect (inflated by margin)
-        const Transform2D to_screen = get_viewport()->get_final_transform();
-        Vector2 p[4];
-        p[0] = to_screen.xform(c[0]);
-        p[1] = to_screen.xform(c[1]);
-        p[2] = to_screen.xform(c[2]);
-        p[3] = to_screen.xform(c[3]);
-        float minx = p[0].x, maxx = p[0].x, miny = p[0].y, maxy = p[0].y;
-        for (int i = 1; i < 4; i++) { minx = std::min(minx, p[i].x); maxx = std::max(maxx, p[i].x); miny = std::min(miny, p[i].y); maxy = std::max(maxy, p[i].y); }
-        Rect2 scr_bb(Vector2(minx, miny), Vector2(maxx - minx, maxy - miny));
-        // Inflate margin in screen pixels then convert back to world approx by inverting to_screen at the center scale.
+        // ViewportRect: world_bb is already in viewport coordinates; intersect with the visible rect
+        // inflated by the margin in viewport pixels.
         const float m = std::max(0.0f, culling_margin_px);
-        scr_bb.position -= Vector2(m, m);
-        scr_bb.size += Vector2(2*m, 2*m);
-        // Convert viewport rect to screen space directly
-        Rect2 vis = get_viewport()->get_visible_rect();
-        return scr_bb.intersects(vis);
+        return world_bb.grow(m).intersects(get_viewport()->get_visible_rect());
     }
 
     // Inflate margin in world units: approximate using camera zoom.x (uniform zoom expected)
@@ -1648,9 +2035,16 @@ void LottieAnimation::_recompute_live_cache_state() {
     if (live_cache_active) cache_only_when_paused = false;
 }
 
-void LottieAnimation::_post_load_to_worker(const String& path) {
-    if (!render_thread_enabled) return;
+void LottieAnimation::_post_load_to_worker(const String& path, tvg::Animation *parsed) {
+    if (!render_thread_enabled) {
+        delete parsed;
+        return;
+    }
     std::lock_guard<std::mutex> lk(job_mutex);
+    // A load that was never picked up is superseded, along with any picture it carried.
+    delete pending_adopt_animation;
+    pending_adopt_animation = parsed;
+    pending_json = path.is_empty() ? PackedByteArray() : loaded_json;
     if (path.is_empty()) {
         pending_path8.clear();
     } else {
@@ -1658,7 +2052,7 @@ void LottieAnimation::_post_load_to_worker(const String& path) {
         pending_path8 = absolute_path.utf8().get_data();
     }
     load_pending = true;
-    job_cv.notify_one();
+    _schedule_worker_locked();
 }
 
 void LottieAnimation::_post_render_to_worker(const Vector2i &size, float frame) {
@@ -1666,8 +2060,11 @@ void LottieAnimation::_post_render_to_worker(const Vector2i &size, float frame)
     std::lock_guard<std::mutex> lk(job_mutex);
     pending_r_size = size;
     pending_r_frame = frame;
+    // Cache lookups happen on the worker, keyed like the main-thread path.
+    pending_r_qf = _quantized_frame_index();
+    pending_r_cache_id = _frame_cache_usable() ? cache_anim_id : 0;
     render_pending = true; // last render wins
-    job_cv.notify_one();
+    _schedule_worker_locked();
 }
 
 void LottieAnimation::_post_segment_to_worker(float begin, float end) {
@@ -1676,7 +2073,7 @@ void LottieAnimation::_post_segment_to_worker(float begin, float end) {
     pending_segment_begin = begin;
     pending_segment_end = end;
     segment_pending = true;
-    job_cv.notify_one();
+    _schedule_worker_locked();
 }
 
 void LottieAnimation::_worker_free_resources() {
@@ -1696,7 +2093,7 @@ void LottieAnimation::_worker_apply_target_if_needed(const Vector2i &size) {
     w_render_size = size;
     w_buffer = new uint32_t[(size_t)size.x * (size_t)size.y];
     memset(w_buffer, 0, (size_t)size.x * (size_t)size.y * sizeof(uint32_t));
-    w_canvas->target(w_buffer, size.x, size.x, size.y, tvg::ColorSpace::ARGB8888S);
+    w_canvas->target(w_buffer, size.x, size.x, size.y, _target_colorspace(premultiplied_alpha));
     // Fit transform will be recomputed below
 }
 
@@ -1714,111 +2111,689 @@ void LottieAnimation::_worker_apply_fit_transform() {
     w_picture->transform(m);
 }
 
-void LottieAnimation::_worker_loop() {
-    tvg::EngineOption worker_opt = tvg::EngineOption::Default;
-    if (engine_option == 1) worker_opt = tvg::EngineOption::SmartRender;
-    
-    w_canvas = tvg::SwCanvas::gen(worker_opt);
+void LottieAnimation::_worker_run_jobs() {
+    // Runs on a LottieRenderPool thread; drains the latest load/segment/render requests once.
     if (!w_canvas) {
-        UtilityFunctions::printerr("Worker: Failed to create ThorVG canvas");
-        return;
-    }
-    
-    while (true) {
-        {
-            std::unique_lock<std::mutex> lk(job_mutex);
-            job_cv.wait(lk, [this]{ return worker_stop || load_pending || render_pending; });
-            if (worker_stop) break;
+        tvg::EngineOption worker_opt = tvg::EngineOption::Default;
+        if (engine_option == 1) worker_opt = tvg::EngineOption::SmartRender;
+        w_canvas = tvg::SwCanvas::gen(worker_opt);
+        if (!w_canvas) {
+            UtilityFunctions::printerr("Worker: Failed to create ThorVG canvas");
+            {
+                std::lock_guard<std::mutex> lk(job_mutex);
+                load_pending = false;
+                render_pending = false;
+                segment_pending = false;
+                job_scheduled = false;
+            }
+            return;
         }
-        // 1) Handle LOAD first if pending
-        bool do_load = false;
-        std::string path8_local;
+    }
+
+    // 1) Handle LOAD first if pending
+    bool do_load = false;
+    std::string path8_local;
+    tvg::Animation *adopt_local = nullptr;
+    PackedByteArray json_local;
     bool do_segment = false;
     float seg_begin_local = 0.0f;
     float seg_end_local = 0.0f;
-        {
-            std::lock_guard<std::mutex> lk(job_mutex);
-            if (load_pending) {
-                path8_local = pending_path8;
-                load_pending = false;
-                do_load = true;
-            }
-            if (segment_pending) {
-                seg_begin_local = pending_segment_begin;
-                seg_end_local = pending_segment_end;
-                segment_pending = false;
-                do_segment = true;
-            }
+    {
+        std::lock_guard<std::mutex> lk(job_mutex);
+        if (load_pending) {
+            path8_local = pending_path8;
+            adopt_local = pending_adopt_animation;
+            pending_adopt_animation = nullptr;
+            json_local = pending_json;
+            pending_json = PackedByteArray();
+            load_pending = false;
+            do_load = true;
         }
-        if (do_load) {
-            // (Re)load animation in worker thread
-            // Clean previous
-            if (w_picture) w_canvas->remove();
-            if (path8_local.empty()) {
-                // Clear resources request
-                w_animation = nullptr;
-                w_picture = nullptr;
-            } else {
-                w_animation = tvg::Animation::gen();
-                w_picture = w_animation->picture();
-                if (w_picture && w_picture->load(path8_local.c_str()) == tvg::Result::Success) {
-                    float pw = 0.0f, ph = 0.0f;
-                    w_picture->size(&pw, &ph);
-                    if (pw <= 0 || ph <= 0) { pw = (float)render_size.x; ph = (float)render_size.y; }
-                    w_base_picture_size = Vector2i((int)std::ceil(pw), (int)std::ceil(ph));
-                    if (w_canvas->push(w_picture) == tvg::Result::Success) {
-                        // ok
-                    } else {
-                        w_animation = nullptr;
-                        w_picture = nullptr;
-                    }
+        if (segment_pending) {
+            seg_begin_local = pending_segment_begin;
+            seg_end_local = pending_segment_end;
+            segment_pending = false;
+            do_segment = true;
+        }
+    }
+    if (do_load) {
+        // (Re)load animation on the worker
+        // Clean previous
+        if (w_picture) w_canvas->remove();
+        w_render_size = Vector2i(0, 0); // re-target: the pixel layout may have changed
+        if (path8_local.empty()) {
+            // Clear resources request
+            w_animation = nullptr;
+            w_picture = nullptr;
+        } else {
+            // An async load hands over a picture it already parsed on a pool thread.
+            w_animation = adopt_local ? adopt_local : tvg::Animation::gen();
+            w_picture = w_animation->picture();
+            if (w_picture && (adopt_local || _load_picture(w_picture, path8_local, json_local))) {
+                float pw = 0.0f, ph = 0.0f;
+                w_picture->size(&pw, &ph);
+                if (pw <= 0 || ph <= 0) { pw = (float)render_size.x; ph = (float)render_size.y; }
+                w_base_picture_size = Vector2i((int)std::ceil(pw), (int)std::ceil(ph));
+                if (w_canvas->push(w_picture) == tvg::Result::Success) {
+                    // ok
                 } else {
                     w_animation = nullptr;
                     w_picture = nullptr;
                 }
+            } else {
+                w_animation = nullptr;
+                w_picture = nullptr;
             }
         }
-        if (do_segment && w_animation) {
-            w_animation->segment(seg_begin_local, seg_end_local);
-        }
-        // 2) Handle RENDER (latest)
-        Vector2i rsize_local;
-        float rframe_local = 0.0f;
-        {
-            std::lock_guard<std::mutex> lk(job_mutex);
-            if (render_pending) {
-                rsize_local = pending_r_size;
-                rframe_local = pending_r_frame;
-                render_pending = false;
-            }
+    }
+    if (do_segment && w_animation) {
+        w_animation->segment(seg_begin_local, seg_end_local);
+    }
+    // 2) Handle RENDER (latest)
+    Vector2i rsize_local;
+    float rframe_local = 0.0f;
+    int rqf_local = 0;
+    uint32_t rcache_id_local = 0;
+    {
+        std::lock_guard<std::mutex> lk(job_mutex);
+        if (render_pending) {
+            rsize_local = pending_r_size;
+            rframe_local = pending_r_frame;
+            rqf_local = pending_r_qf;
+            rcache_id_local = pending_r_cache_id;
+            render_pending = false;
         }
-        if (rsize_local.x > 0 && rsize_local.y > 0) {
-            if (!w_canvas || !w_animation || !w_picture) continue;
+    }
+    if (rsize_local.x > 0 && rsize_local.y > 0 && w_animation && w_picture) {
+        PackedByteArray out;
+        bool recyclable = true;
+        const auto render_start = std::chrono::steady_clock::now();
+        uint64_t same_as_id = 0;
+        uint64_t base_id = 0;
+        Rect2i changed;
+        bool obsolete = false;
+        bool owned = false;
+        if (rcache_id_local != 0 && LottieFrameCache::get_singleton()->get(rcache_id_local, rqf_local, rsize_local, out, &owned)) {
+            // Cache hit: skip ThorVG entirely and hand over the pixels, shared unless they were
+            // decoded into a pooled buffer. w_diff still describes w_buffer, so the next
+            // rasterized frame is diffed against it as usual.
+            recyclable = owned;
+        } else {
             _worker_apply_target_if_needed(rsize_local);
             _worker_apply_fit_transform();
             w_animation->frame(rframe_local);
             w_canvas->update();
             w_canvas->draw(false);
             w_canvas->sync();
-            std::vector<uint8_t> tmp;
-            tmp.resize((size_t)w_render_size.x * (size_t)w_render_size.y * 4);
-            // Optimized ARGB->RGBA conversion for worker-produced buffer.
-            _convert_argb_to_rgba_optimized(w_buffer, tmp.data(), (size_t)w_render_size.x * (size_t)w_render_size.y);
-            if (unpremultiply_alpha) {
-                _unpremultiply_alpha_rgba(tmp.data(), w_render_size.x, w_render_size.y);
+            {
+                // The main thread drops frames of a stale size, so with a resize already queued
+                // this one would never be uploaded: skip the diff and conversion.
+                std::lock_guard<std::mutex> lk(job_mutex);
+                obsolete = render_pending && pending_r_size != rsize_local;
             }
-            if (fix_alpha_border) {
-                _fix_alpha_border_rgba(tmp.data(), w_render_size.x, w_render_size.y);
+            Rect2i dirty;
+            if (obsolete) {
+                // Nothing to publish.
+            } else if (!w_diff.update(w_buffer, rsize_local.x, rsize_local.y, unpremultiply_alpha, fix_alpha_border, premultiplied_alpha, dirty)) {
+                // Pixel-identical to the previous frame: hand its buffer over again so the main
+                // thread can skip the upload if it already shows it.
+                out = w_diff.rgba;
+                recyclable = false;
+                same_as_id = w_diff.frame_id;
+            } else {
+                // Convert straight into the array that is handed to Image::set_data() on the main thread.
+                base_id = w_diff.frame_id;
+                out = w_diff.produce(w_buffer, dirty, changed);
+                // Back first: until the new frame is published, only this thread can reach it.
+                w_diff_back_ptr.store(w_diff.back.ptr(), std::memory_order_release);
+                w_diff_rgba_ptr.store(w_diff.rgba.ptr(), std::memory_order_release);
+            }
+            if (rcache_id_local != 0 && same_as_id == 0 && !obsolete) {
+                LottieFrameCache::get_singleton()->put(rcache_id_local, rqf_local, rsize_local, out);
+                recyclable = false;
             }
+        }
+        if (!obsolete) {
+            worker_render_cost_ms.store(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - render_start).count());
+            PackedByteArray superseded;
+            bool superseded_recyclable = false;
             {
                 std::lock_guard<std::mutex> lk(frame_mutex);
-                latest_frame.rgba.swap(tmp);
-                latest_frame.w = w_render_size.x;
-                latest_frame.h = w_render_size.y;
+                superseded = latest_frame.rgba; // never consumed by the main thread
+                superseded_recyclable = latest_frame.recyclable;
+                latest_frame.rgba = out;
+                latest_frame.recyclable = recyclable;
+                latest_frame.qf = rqf_local;
+                latest_frame.same_as_id = same_as_id;
+                latest_frame.base_id = base_id;
+                latest_frame.changed = changed;
+                latest_frame.w = rsize_local.x;
+                latest_frame.h = rsize_local.y;
                 latest_frame.id = next_frame_id++;
+                if (w_diff.valid) w_diff.frame_id = same_as_id != 0 ? same_as_id : latest_frame.id;
                 latest_frame.ready = true;
             }
+            out = PackedByteArray();
+            // The superseded frame is one of w_diff's buffers unless a cache hit or a newer frame replaced it.
+            if (superseded_recyclable && superseded.ptr() != w_diff.rgba.ptr() && superseded.ptr() != w_diff.back.ptr()) LottieFrameBufferPool::get_singleton()->release(superseded);
+        }
+    }
+
+    // 3) Requeue if new requests arrived while this pass was running
+    {
+        std::lock_guard<std::mutex> lk(job_mutex);
+        if (load_pending || render_pending || segment_pending) {
+            LottieRenderPool::get_singleton()->submit(this, [this]() { _worker_run_jobs(); });
+        } else {
+            job_scheduled = false;
+        }
+    }
+}
+
+bool LottieAnimation::bake_frames(int from_frame, int to_frame, const Vector2i &size) {
+    if (!_has_animation() || loaded_path8.empty() || total_frames <= 0) return false;
+    cancel_bake();
+
+    const Vector2i bake_size = (size.x > 0 && size.y > 0) ? size : render_size;
+    if (bake_size.x <= 0 || bake_size.y <= 0) return false;
+    const int step = std::max(1, frame_cache_step);
+    const int last = (int)total_frames - 1;
+    from_frame = std::clamp(from_frame, 0, last);
+    to_frame = std::clamp(to_frame, from_frame, last);
+    // Bake the same quantized indices playback looks up.
+    std::vector<int> frames;
+    for (int f = (from_frame / step) * step; f <= to_frame; f += step) frames.push_back(f);
+    if (frames.empty()) return false;
+
+    // Baked frames are only useful if playback consults the cache.
+    frame_cache_enabled = true;
+    cache_only_when_paused = false;
+    _ensure_cache_capacity();
+    const size_t frame_bytes = (size_t)bake_size.x * (size_t)bake_size.y * 4;
+    const size_t budget = (size_t)std::max(16, frame_cache_budget_mb) * 1024ull * 1024ull;
+    if (frame_bytes * frames.size() > budget) {
+        UtilityFunctions::printerr("bake_frames: range exceeds frame_cache/budget_mb; early frames will be evicted");
+    }
+
+    std::shared_ptr<BakeJob> job = std::make_shared<BakeJob>();
+    job->total = (int)frames.size();
+    bake_job = job;
+    bake_reported = -1;
+
+    const std::string path8 = loaded_path8;
+    const PackedByteArray json = loaded_json;
+    const uint32_t anim_id = cache_anim_id;
+    const bool unpremultiply = unpremultiply_alpha;
+    const bool fix_border = fix_alpha_border;
+    const bool premultiplied = premultiplied_alpha;
+    const int engine = engine_option;
+    const bool has_segment = segment_active;
+    const float seg_begin = segment_begin;
+    const float seg_end = segment_end;
+
+    auto bake_chunk = [job, path8, json, anim_id, bake_size, unpremultiply, fix_border, premultiplied, engine, has_segment, seg_begin, seg_end](std::vector<int> chunk) {
+        _OffscreenRenderer r;
+        if (!r.load(path8, json, engine, premultiplied)) {
+            job->failed += (int)chunk.size();
+            job->done += (int)chunk.size();
+            return;
+        }
+        if (has_segment) r.animation->segment(seg_begin, seg_end);
+        LottieFrameCache *cache = LottieFrameCache::get_singleton();
+        for (int f : chunk) {
+            if (job->cancelled) return;
+            PackedByteArray rgba;
+            if (!cache->get(anim_id, f, bake_size, rgba)) {
+                rgba.resize((int64_t)bake_size.x * (int64_t)bake_size.y * 4);
+                r.render((float)f, bake_size, unpremultiply, fix_border, rgba.ptrw());
+                cache->put(anim_id, f, bake_size, rgba);
+            }
+            job->done++;
+        }
+    };
+
+    if (!render_thread_enabled) {
+        // No worker threads (Web): bake synchronously; signals follow on the next _process().
+        bake_chunk(frames);
+        return true;
+    }
+    // One contiguous chunk per pool thread; every chunk parses its own picture.
+    LottieRenderPool *pool = LottieRenderPool::get_singleton();
+    const int chunks = std::min((int)frames.size(), pool->get_thread_count());
+    const size_t per_chunk = (frames.size() + (size_t)chunks - 1) / (size_t)chunks;
+    for (size_t i = 0; i < frames.size(); i += per_chunk) {
+        std::vector<int> chunk(frames.begin() + i, frames.begin() + std::min(frames.size(), i + per_chunk));
+        pool->submit(job.get(), [bake_chunk, chunk]() { bake_chunk(chunk); });
+    }
+    return true;
+}
+
+void LottieAnimation::cancel_bake() {
+    if (!bake_job) return;
+    bake_job->cancelled = true;
+    if (LottieRenderPool::has_singleton()) {
+        LottieRenderPool::get_singleton()->cancel(bake_job.get());
+    }
+    bake_job.reset();
+}
+
+bool LottieAnimation::is_baking() const {
+    return bake_job && bake_job->done.load() < bake_job->total;
+}
+
+void LottieAnimation::_poll_bake_progress() {
+    if (!bake_job) return;
+    const int done = bake_job->done.load();
+    if (done == bake_reported) return;
+    bake_reported = done;
+    emit_signal("bake_progress", done, bake_job->total);
+    if (done >= bake_job->total) {
+        const int baked = bake_job->total - bake_job->failed.load();
+        bake_job.reset();
+        emit_signal("bake_completed", baked);
+    }
+}
+
+bool LottieAnimation::bake_sprite_atlas(const Vector2i &frame_size, int frame_step, const String &marker) {
+    if (!_has_animation() || loaded_path8.empty() || total_frames <= 0) return false;
+    if (frame_size.x <= 0 || frame_size.y <= 0 || frame_size.x > ATLAS_MAX_SIZE || frame_size.y > ATLAS_MAX_SIZE) {
+        UtilityFunctions::printerr("bake_sprite_atlas: frame_size must be within 1..4096");
+        return false;
+    }
+    frame_step = std::max(1, frame_step);
+    float first = 0.0f;
+    float last = total_frames - 1.0f;
+    if (!marker.is_empty()) {
+        float sb = 0.0f, se = 0.0f;
+        if (!_find_marker_range(marker, sb, se)) {
+            UtilityFunctions::printerr("bake_sprite_atlas: marker not found: " + marker);
+            return false;
+        }
+        first = sb;
+        last = std::max(sb, se - 1.0f);
+    }
+    std::vector<float> frames;
+    for (float f = first; f <= last; f += (float)frame_step) frames.push_back(f);
+
+    _cancel_atlas_bake();
+    std::shared_ptr<AtlasBakeJob> job = std::make_shared<AtlasBakeJob>();
+    job->frames = std::move(frames);
+    job->first = first;
+    job->last = last;
+    job->frame_step = frame_step;
+
+    // Fill pages row-major with as many cells as fit in ATLAS_MAX_SIZE on each axis.
+    const int fw = frame_size.x;
+    const int fh = frame_size.y;
+    const int cols = std::max(1, ATLAS_MAX_SIZE / fw);
+    const int per_page = cols * std::max(1, ATLAS_MAX_SIZE / fh);
+    const int count = (int)job->frames.size();
+    const int page_count = (count + per_page - 1) / per_page;
+    job->pages.resize((size_t)page_count);
+    job->page_sizes.resize((size_t)page_count);
+    job->page_ptrs.resize((size_t)page_count);
+    for (int p = 0; p < page_count; ++p) {
+        const int cells = std::min(per_page, count - p * per_page);
+        job->page_sizes[p] = Vector2i(std::min(cells, cols) * fw, ((cells + cols - 1) / cols) * fh);
+        job->pages[p].resize((int64_t)job->page_sizes[p].x * (int64_t)job->page_sizes[p].y * 4);
+        job->pages[p].fill(0);
+        job->page_ptrs[p] = job->pages[p].ptrw();
+    }
+    job->rects.resize((size_t)count);
+    for (int i = 0; i < count; ++i) {
+        const int cell = i % per_page;
+        job->rects[i].page = i / per_page;
+        job->rects[i].rect = Rect2((float)((cell % cols) * fw), (float)((cell / cols) * fh), (float)fw, (float)fh);
+    }
+
+    const std::string path8 = loaded_path8;
+    const PackedByteArray json = loaded_json;
+    const bool unpremultiply = unpremultiply_alpha;
+    const bool fix_border = fix_alpha_border;
+    const bool premultiplied = premultiplied_alpha;
+    const int engine = engine_option;
+    // Renders frames [begin, end) and blits each into its cell; cells never overlap,
+    // so chunks can run concurrently.
+    auto bake_range = [job, path8, json, engine, premultiplied, unpremultiply, fix_border, frame_size](int begin, int end) {
+        _OffscreenRenderer r;
+        if (!job->cancelled && !r.load(path8, json, engine, premultiplied)) job->failed = true;
+        const int fw = frame_size.x;
+        const int fh = frame_size.y;
+        std::vector<uint8_t> cell_rgba;
+        for (int i = begin; i < end && !job->cancelled && !job->failed; ++i) {
+            cell_rgba.resize((size_t)fw * (size_t)fh * 4);
+            r.render(job->frames[i], frame_size, unpremultiply, fix_border, cell_rgba.data());
+            const AtlasFrame &af = job->rects[i];
+            const size_t pitch = (size_t)job->page_sizes[af.page].x * 4;
+            uint8_t *dst = job->page_ptrs[af.page] + (size_t)af.rect.position.y * pitch + (size_t)af.rect.position.x * 4;
+            for (int y = 0; y < fh; ++y) {
+                memcpy(dst + (size_t)y * pitch, cell_rgba.data() + (size_t)y * (size_t)fw * 4, (size_t)fw * 4);
+            }
+        }
+        job->chunks_left.fetch_sub(1, std::memory_order_acq_rel);
+    };
+
+    atlas_job = job;
+    if (!render_thread_enabled) {
+        // No worker threads (Web): bake now; the atlas is installed on the next _process().
+        job->chunks_left = 1;
+        bake_range(0, count);
+        return true;
+    }
+    // One contiguous chunk per pool thread; every chunk parses its own picture.
+    LottieRenderPool *pool = LottieRenderPool::get_singleton();
+    const int chunks = std::min(count, pool->get_thread_count());
+    const int per_chunk = (count + chunks - 1) / chunks;
+    job->chunks_left = (count + per_chunk - 1) / per_chunk;
+    for (int i = 0; i < count; i += per_chunk) {
+        const int end = std::min(count, i + per_chunk);
+        pool->submit(job.get(), [bake_range, i, end]() { bake_range(i, end); });
+    }
+    return true;
+}
+
+void LottieAnimation::_poll_atlas_bake() {
+    if (!atlas_job || atlas_job->chunks_left.load(std::memory_order_acquire) > 0) return;
+    std::shared_ptr<AtlasBakeJob> job = atlas_job;
+    atlas_job.reset();
+    if (job->failed) {
+        UtilityFunctions::printerr("bake_sprite_atlas: failed to load animation for baking");
+        emit_signal("atlas_baked", false);
+        return;
+    }
+
+    atlas_textures.clear();
+    for (size_t p = 0; p < job->pages.size(); ++p) {
+        Ref<Image> img = Image::create_from_data(job->page_sizes[p].x, job->page_sizes[p].y, false, Image::FORMAT_RGBA8, job->pages[p]);
+        atlas_textures.push_back(ImageTexture::create_from_image(img));
+    }
+    atlas_frames = std::move(job->rects);
+    atlas_first_frame = job->first;
+    atlas_last_frame = job->last;
+    atlas_frame_step = job->frame_step;
+    atlas_drawn_index = -1;
+    atlas_playback = true;
+    if (current_frame < job->first || current_frame > job->last) current_frame = job->first;
+    queue_redraw();
+    emit_signal("atlas_baked", true);
+}
+
+void LottieAnimation::_cancel_atlas_bake() {
+    if (!atlas_job) return;
+    atlas_job->cancelled = true;
+    if (LottieRenderPool::has_singleton()) {
+        LottieRenderPool::get_singleton()->cancel(atlas_job.get());
+    }
+    atlas_job.reset();
+}
+
+void LottieAnimation::clear_sprite_atlas() {
+    _cancel_atlas_bake();
+    atlas_textures.clear();
+    atlas_frames.clear();
+    atlas_drawn_index = -1;
+    // Force the regular path to post/render again.
+    last_posted_qf = -1;
+    last_rendered_qf = -1;
+    queue_redraw();
+}
+
+int LottieAnimation::_atlas_index_for_frame(float frame) const {
+    int idx = (int)((frame - atlas_first_frame) / (float)atlas_frame_step);
+    return std::clamp(idx, 0, (int)atlas_frames.size() - 1);
+}
+
+Array LottieAnimation::get_atlas_textures() const {
+    Array out;
+    for (const Ref<ImageTexture> &tex : atlas_textures) out.push_back(tex);
+    return out;
+}
+
+Array LottieAnimation::get_atlas_frames() const {
+    Array out;
+    for (const AtlasFrame &af : atlas_frames) {
+        Dictionary d;
+        d["atlas"] = af.page;
+        d["rect"] = af.rect;
+        out.push_back(d);
+    }
+    return out;
+}
+
+void LottieAnimation::set_atlas_playback(bool p_enable) {
+    if (atlas_playback == p_enable) return;
+    atlas_playback = p_enable;
+    atlas_drawn_index = -1;
+    last_posted_qf = -1;
+    last_rendered_qf = -1;
+    queue_redraw();
+}
+
+bool LottieAnimation::is_atlas_playback() const { return atlas_playback; }
+
+void LottieAnimation::_shared_sync_group() {
+    uint64_t want = 0;
+    if (shared_instance && cache_anim_id != 0 && render_size.x > 0 && render_size.y > 0) {
+        // Instances only agree on pixels when they play the same segment; cache_anim_id already
+        // separates the pixel post-processing variants.
+        String variant = String::num_int64(cache_anim_id);
+        if (segment_active) variant += "#seg" + String::num(segment_begin) + ":" + String::num(segment_end);
+        if (variant != shared_variant_key) {
+            shared_variant_key = variant;
+            shared_variant_id = LottieFrameCache::get_singleton()->intern(variant);
+        }
+        want = _shared_group_key(shared_variant_id, render_size);
+    }
+    if (want == shared_group) return;
+    _shared_leave_group();
+    if (want == 0) return;
+    g_shared_frames[want].users += 1;
+    shared_group = want;
+}
+
+void LottieAnimation::_shared_leave_group() {
+    if (shared_group == 0) return;
+    auto it = g_shared_frames.find(shared_group);
+    shared_group = 0;
+    if (it == g_shared_frames.end()) return;
+    _SharedFrameGroup &g = it->second;
+    for (auto p = g.pending.begin(); p != g.pending.end();) {
+        if (p->second.owner == this) p = g.pending.erase(p);
+        else ++p;
+    }
+    if (--g.users <= 0) g_shared_frames.erase(it);
+}
+
+bool LottieAnimation::_shared_try_borrow(int qf) {
+    auto it = g_shared_frames.find(shared_group);
+    if (it == g_shared_frames.end()) return false;
+    for (_SharedFrameGroup::Slot &slot : it->second.slots) {
+        if (slot.qf != qf || slot.texture.is_null()) continue;
+        slot.last_used = Engine::get_singleton()->get_process_frames();
+        if (texture.ptr() != slot.texture.ptr()) {
+            texture = slot.texture;
+            shown_frame_id = 0;
+            _uploaded_this_frame = true;
+        }
+        // Keep both paths from re-rendering a frame that is already on screen.
+        last_rendered_qf = qf;
+        last_posted_qf = qf;
+        last_posted_size = render_size;
+        first_frame_drawn = true;
+        return true;
+    }
+    return false;
+}
+
+bool LottieAnimation::_shared_pending_elsewhere(int qf) const {
+    if (shared_group == 0) return false;
+    auto it = g_shared_frames.find(shared_group);
+    if (it == g_shared_frames.end()) return false;
+    auto p = it->second.pending.find(qf);
+    if (p == it->second.pending.end() || p->second.owner == this) return false;
+    return Engine::get_singleton()->get_process_frames() - p->second.since < SHARED_PENDING_TIMEOUT;
+}
+
+void LottieAnimation::_shared_mark_pending(int qf) {
+    if (shared_group == 0) return;
+    auto it = g_shared_frames.find(shared_group);
+    if (it == g_shared_frames.end()) return;
+    // A node has at most one render in flight; forget the frame it no longer waits for.
+    for (auto p = it->second.pending.begin(); p != it->second.pending.end();) {
+        if (p->second.owner == this) p = it->second.pending.erase(p);
+        else ++p;
+    }
+    it->second.pending[qf] = _SharedFrameGroup::Pending{this, Engine::get_singleton()->get_process_frames()};
+}
+
+bool LottieAnimation::_shared_publish(int qf) {
+    if (shared_group == 0 || qf < 0) return false;
+    auto it = g_shared_frames.find(shared_group);
+    if (it == g_shared_frames.end()) return false;
+    _SharedFrameGroup &g = it->second;
+    auto p = g.pending.find(qf);
+    if (p != g.pending.end() && p->second.owner == this) g.pending.erase(p);
+
+    const uint64_t now = Engine::get_singleton()->get_process_frames();
+    _SharedFrameGroup::Slot *target = nullptr;
+    for (_SharedFrameGroup::Slot &slot : g.slots) {
+        if (slot.qf == qf) { target = &slot; break; }
+        if (now - slot.last_used < 2) continue; // still on screen somewhere
+        if (!target || slot.last_used < target->last_used) target = &slot;
+    }
+    if (!target) {
+        if ((int)g.slots.size() >= SHARED_MAX_SLOTS) return false;
+        g.slots.push_back(_SharedFrameGroup::Slot());
+        target = &g.slots.back();
+        target->texture = ImageTexture::create_from_image(image);
+    } else {
+        target->texture->update(image);
+    }
+    target->qf = qf;
+    target->last_used = now;
+    texture = target->texture;
+    return true;
+}
+
+float LottieAnimation::_screen_coverage() const {
+    // Fraction of the viewport covered by the drawn box, clipped to the visible rect.
+    if (!is_inside_tree() || !get_viewport()) return 1.0f;
+    const Vector2 size((float)fit_box_size.x, (float)fit_box_size.y);
+    const Transform2D to_canvas = get_global_transform_with_canvas();
+    const Vector2 origin = -size * 0.5f + offset;
+    Vector2 c[4] = {
+        to_canvas.xform(origin),
+        to_canvas.xform(origin + Vector2(size.x, 0.0f)),
+        to_canvas.xform(origin + Vector2(0.0f, size.y)),
+        to_canvas.xform(origin + size),
+    };
+    Rect2 bb(c[0], Vector2());
+    for (int i = 1; i < 4; ++i) bb.expand_to(c[i]);
+    const Rect2 vis = get_viewport()->get_visible_rect();
+    const float vis_area = vis.size.x * vis.size.y;
+    if (vis_area <= 0.0f) return 1.0f;
+    const Rect2 clipped = bb.intersection(vis);
+    return std::clamp(clipped.size.x * clipped.size.y / vis_area, 0.0f, 1.0f);
+}
+
+float LottieAnimation::_render_priority() const {
+    // Large on-screen animations first, scaled by render_focus. The small floor keeps tiny
+    // ones ordered by the same rules, and every deferred frame multiplies the priority,
+    // so background animations degrade first but never starve.
+    const float coverage = _screen_coverage();
+    return (coverage + 0.01f) * render_focus * (1.0f + (float)schedule_skips);
+}
+
+void LottieAnimation::_request_render() {
+    LottieRenderScheduler *scheduler = LottieRenderScheduler::get_singleton();
+    if (!scheduler->is_enabled() || Engine::get_singleton()->is_editor_hint()) {
+        _run_scheduled_render();
+        return;
+    }
+    if (schedule_requested) return;
+    schedule_requested = true;
+    scheduler->request(this, _render_priority(), render_cost_ms, render_thread_enabled);
+}
+
+void LottieAnimation::_run_scheduled_render() {
+    schedule_requested = false;
+    schedule_skips = 0;
+    if (render_thread_enabled) {
+        int qf = _quantized_frame_index();
+        _post_render_to_worker(render_size, current_frame);
+        _shared_mark_pending(qf);
+        last_posted_size = render_size;
+        last_posted_qf = qf;
+        return;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    _render_frame();
+    _note_render_cost(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    // May run after _process() when admitted by the scheduler.
+    if (_uploaded_this_frame) queue_redraw();
+}
+
+void LottieAnimation::_on_render_skipped() {
+    schedule_requested = false;
+    schedule_skips += 1;
+}
+
+void LottieAnimation::_note_render_cost(double ms) {
+    render_cost_ms = render_cost_ms * 0.8 + ms * 0.2;
+}
+
+void LottieAnimation::set_shared_instance(bool p_enable) {
+    if (shared_instance == p_enable) return;
+    shared_instance = p_enable;
+    if (!shared_instance) {
+        _shared_leave_group();
+        // Back to a private texture on the next upload.
+        last_posted_qf = -1;
+        last_rendered_qf = -1;
+    }
+}
+
+bool LottieAnimation::is_shared_instance() const { return shared_instance; }
+
+void LottieAnimation::set_render_focus(float p_focus) { render_focus = std::max(0.0f, p_focus); }
+float LottieAnimation::get_render_focus() const { return render_focus; }
+
+void LottieAnimation::set_premultiplied_alpha(bool p_enable) {
+    if (premultiplied_alpha == p_enable) return;
+    premultiplied_alpha = p_enable;
+    _apply_premultiplied_material();
+    // Canvas targets, cache ids and baked data all depend on the pixel layout: reload.
+    if (is_inside_tree() && !animation_path.is_empty()) {
+        clear_sprite_atlas();
+        _load_animation(animation_path);
+        render_static();
+    }
+}
+
+bool LottieAnimation::is_premultiplied_alpha() const { return premultiplied_alpha; }
+
+void LottieAnimation::set_async_load(bool p_enable) { async_load = p_enable; }
+bool LottieAnimation::is_async_load() const { return async_load; }
+
+void LottieAnimation::set_placeholder_texture(const Ref<Texture2D> &p_texture) {
+    placeholder_texture = p_texture;
+    if (_is_async_loading()) queue_redraw();
+}
+
+Ref<Texture2D> LottieAnimation::get_placeholder_texture() const { return placeholder_texture; }
+
+void LottieAnimation::_apply_premultiplied_material() {
+    // Leaves a user-assigned material alone; only our own material is installed or removed.
+    if (premultiplied_alpha) {
+        if (premultiplied_material.is_null()) {
+            premultiplied_material.instantiate();
+            premultiplied_material->set_blend_mode(CanvasItemMaterial::BLEND_MODE_PREMULT_ALPHA);
+        }
+        if (get_material().is_null()) {
+            set_material(premultiplied_material);
         }
+    } else if (premultiplied_material.is_valid() && get_material().ptr() == premultiplied_material.ptr()) {
+        set_material(Ref<Material>());
     }
 }
 
@@ -4,18 +4,25 @@
 #include <godot_cpp/classes/node2d.hpp>
 #include <godot_cpp/classes/image.hpp>
 #include <godot_cpp/classes/image_texture.hpp>
+#include <godot_cpp/classes/canvas_item_material.hpp>
+#include <godot_cpp/classes/texture2d.hpp>
+#include <godot_cpp/classes/texture2drd.hpp>
 #include <godot_cpp/variant/string.hpp>
 #include <godot_cpp/classes/viewport.hpp>
 #include <godot_cpp/variant/packed_string_array.hpp>
 #include <godot_cpp/variant/dictionary.hpp>
 #include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/variant/array.hpp>
 #include <vector>
 #include <string>
-#include <thread>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <memory>
 #include "lottie_frame_cache.h"
+#include "lottie_marker_index.h"
+#include "lottie_archive.h"
+#include "lottie_manifest.h"
 
 namespace tvg {
     class SwCanvas;
@@ -38,12 +45,27 @@ private:
     float total_frames;
     float duration;
     
-    Ref<ImageTexture> texture;
+    Ref<Texture2D> texture; // what _draw() shows: a ring slot, rd_texture or a shared slot
     Ref<Image> image;
     PackedByteArray pixel_bytes;
+    PackedByteArray uploaded_rgba; // pooled buffer currently shared with `image`
+    bool uploaded_recyclable = false;
+    uint32_t cache_anim_id = 0; // LottieFrameCache id interned from animation_key
     std::vector<Ref<ImageTexture>> texture_ring;
     int texture_ring_index = 0;
     int texture_ring_size = 3;
+    // On RenderingDevice renderers (Forward+, Mobile) the ring is replaced by one texture that
+    // frames are patched into: the changed rect goes to a staging texture, sized to it rounded
+    // up to RD_STAGING_STEP, and is copied into place on the GPU. Compatibility keeps the ring.
+    static constexpr int RD_STAGING_STEP = 64;
+    Ref<Texture2DRD> rd_texture;
+    RID rd_target;
+    RID rd_staging;
+    Vector2i rd_staging_size;
+    PackedByteArray rd_staging_bytes;
+    bool _create_rd_target();
+    void _free_rd_target();
+    bool _rd_upload(const PackedByteArray &rgba, const Rect2i &changed);
     Vector2i base_picture_size;
     Vector2i render_size;
     String animation_key;
@@ -69,21 +91,75 @@ private:
     bool live_cache_force = false;
     bool live_cache_active = false;
 
-    int culling_mode = 2;
+    int culling_mode = 0; // 0 = ViewportRect, 1 = CameraWorld, 2 = Disabled
     float culling_margin_px = 0.0f;
 
     bool render_thread_enabled = true;
-    std::thread render_thread;
+    // Render jobs run on the shared LottieRenderPool; job_scheduled keeps at most
+    // one pool task per node in flight so the worker-side ThorVG state stays serialized.
     std::mutex job_mutex;
-    std::condition_variable job_cv;
-    bool worker_stop = false;
+    bool job_scheduled = false;
+    // When true (threaded builds), the worker owns the only ThorVG picture and the main
+    // thread keeps just the metadata from WorkerLoadReply.
+    bool single_picture_owner = true;
+    bool worker_picture_loaded = false;
+    struct WorkerLoadReply {
+        bool ok = false;
+        float duration = 0.0f;
+        float total_frames = 0.0f;
+        float width = 0.0f;
+        float height = 0.0f;
+    };
     bool load_pending = false;
     std::string pending_path8;
+    tvg::Animation *pending_adopt_animation = nullptr; // already parsed picture for the next load
+    PackedByteArray pending_json; // in-memory JSON for the next load (empty = load pending_path8)
     bool render_pending = false;
     Vector2i pending_r_size;
     float pending_r_frame = 0.0f;
+    int pending_r_qf = 0;
+    uint32_t pending_r_cache_id = 0;
     uint64_t next_frame_id = 1;
     uint64_t last_consumed_id = 0;
+
+    // Tracks the last rasterized frame so that only the region that changed since then is
+    // converted and post-processed again (ThorVG does not report its dirty regions). Two output
+    // buffers take turns: each frame is written over the one before last, so only the union of
+    // the last two changed rects is redone and nothing else is copied.
+    struct FrameDiff {
+        std::vector<uint32_t> argb; // raw ThorVG output of the previous frame
+        PackedByteArray rgba; // post-processed pixels of the previous frame
+        PackedByteArray back; // the frame before it; the next frame is written over it
+        Rect2i back_stale; // where `back` differs from `rgba`
+        uint64_t frame_id = 0; // id under which the previous frame was published (worker)
+        int w = 0;
+        int h = 0;
+        bool unpremultiply = false;
+        bool fix_border = false;
+        bool premultiplied = false;
+        bool valid = false;
+        int skip_frames = 0; // frames left to convert whole without diffing
+        // Diffs src against the previous frame and keeps it. Returns false when nothing changed;
+        // otherwise r_dirty is the changed rect (the whole frame without a usable previous one).
+        // Once a frame changes over most of its area, the next few are not diffed at all.
+        bool update(const uint32_t *src, int p_w, int p_h, bool p_unpremultiply, bool p_fix_border, bool p_premultiplied, Rect2i &r_dirty);
+        // Post-processes src into the older buffer, which becomes `rgba`, and returns it. Pixels
+        // that cannot differ from it are left alone; r_changed is the rect that differs from the
+        // previous `rgba`.
+        PackedByteArray produce(const uint32_t *src, const Rect2i &dirty, Rect2i &r_changed);
+    };
+    FrameDiff w_diff; // worker thread only
+    FrameDiff main_diff; // main-thread render path only
+    // Storage of w_diff.rgba and w_diff.back, published after every change. The diffs keep the
+    // last two buffers they produced (and hand the newest out again for pixel-identical frames),
+    // so neither may go back to LottieFrameBufferPool while a diff still holds it.
+    std::atomic<const uint8_t *> w_diff_rgba_ptr{nullptr};
+    std::atomic<const uint8_t *> w_diff_back_ptr{nullptr};
+    bool _frame_buffer_retained(const PackedByteArray &rgba) const;
+    void _release_frame_buffer(PackedByteArray &rgba);
+    // What the texture currently shows: a worker frame id, MAIN_DIFF_FRAME, or 0 (unknown)
+    static constexpr uint64_t MAIN_DIFF_FRAME = ~0ull;
+    uint64_t shown_frame_id = 0;
     // Render deduplication
     int last_rendered_qf = -1;
     int last_posted_qf = -1;
@@ -92,7 +168,12 @@ private:
     bool first_frame_drawn = false;
 
     struct FrameResult {
-        std::vector<uint8_t> rgba;
+        PackedByteArray rgba; // handed to the main thread by reference, never copied
+        bool recyclable = false; // false when shared with LottieFrameCache
+        int qf = -1; // quantized frame index the pixels belong to
+        uint64_t same_as_id = 0; // pixels identical to this earlier frame id (0 = changed)
+        uint64_t base_id = 0; // frame the pixels only differ from within `changed` (0 = unknown)
+        Rect2i changed;
         int w = 0;
         int h = 0;
         uint64_t id = 0;
@@ -119,22 +200,63 @@ private:
 
     bool fix_alpha_border = true;
     bool unpremultiply_alpha = false;
+    // ThorVG renders premultiplied RGBA straight into the upload layout and the node draws
+    // with a premultiplied-alpha blend, so frames need no swizzle/unpremultiply/border pass.
+    bool premultiplied_alpha = false;
+    Ref<CanvasItemMaterial> premultiplied_material; // installed while premultiplied_alpha is on
+    void _apply_premultiplied_material();
 
     Vector2 offset = Vector2();
 
     String last_lottie_zip_path;
-    PackedStringArray sm_animation_ids;
-    PackedStringArray sm_machine_names;
-    Dictionary sm_states_by_machine;
-    Dictionary sm_anim_inner_paths;
-    Dictionary sm_state_segments_by_machine;
+    std::shared_ptr<const LottieManifest> dotlottie_manifest = LottieManifest::empty();
+    // Keeps the bundle's handle open (LottieArchive registry) while this node plays from it;
+    // released on path change and when leaving the tree.
+    std::shared_ptr<LottieArchive> dotlottie_archive;
     String active_animation_id;
     String active_state_machine;
     String active_state;
 
+    // async_load: manifest parsing, bundle extraction and the ThorVG parse run as one render-pool
+    // task; placeholder_texture is drawn until _process adopts the finished job. A superseded
+    // job is simply dropped: the task owns its own reference and frees the picture it parsed.
+    struct AsyncLoadJob {
+        String path; // requested animation_path
+        String animation_id; // active .lottie animation at submit time
+        String selected_animation;
+        std::atomic<bool> done{false};
+        // Results, valid once `done` is set
+        bool ok = false;
+        bool is_dotlottie = false;
+        std::shared_ptr<const LottieManifest> manifest;
+        std::shared_ptr<LottieArchive> archive;
+        String source_path; // JSON that was parsed, or its archive entry key for in-memory loads
+        PackedByteArray json; // JSON read from the bundle without extraction
+        std::string path8; // absolute path ThorVG loaded
+        std::shared_ptr<const LottieMarkerIndex> markers;
+        tvg::Animation *animation = nullptr; // owned until adopted by the node or its worker
+        float duration = 0.0f;
+        float total_frames = 0.0f;
+        float width = 0.0f;
+        float height = 0.0f;
+        ~AsyncLoadJob();
+    };
+    bool async_load = false;
+    Ref<Texture2D> placeholder_texture;
+    // Child canvas item the placeholder is drawn into: it is a straight-alpha texture, so it must
+    // not go through the node's premultiplied-alpha material.
+    RID placeholder_item;
+    void _draw_placeholder();
+    std::shared_ptr<AsyncLoadJob> async_job;
+    static void _run_async_load(AsyncLoadJob &job);
+    void _poll_async_load();
+    bool _is_async_loading() const { return async_job != nullptr; }
+
     void _initialize_thorvg();
     void _cleanup_thorvg();
     bool _load_animation(const String& path);
+    void _unload_current_animation();
+    bool _finish_load(const String &source_path, AsyncLoadJob *parsed, const PackedByteArray &json = PackedByteArray());
     void _update_animation(float delta);
     void _render_frame();
     void _create_texture();
@@ -146,28 +268,118 @@ private:
     void _on_viewport_size_changed();
     int _quantized_frame_index() const;
     void _ensure_cache_capacity();
+    // `changed` bounds where rgba differs from the frame on screen; empty when that is unknown.
+    void _upload_rgba(const PackedByteArray &rgba, bool recyclable, int qf, const Rect2i &changed = Rect2i());
+    void _recycle_uploaded_buffer(const PackedByteArray &now_uploaded, bool recyclable);
+    bool _frame_cache_usable() const;
     bool _is_visible_on_screen() const;
     void _recompute_live_cache_state();
     void _parse_dotlottie_manifest(const String &zip_path);
+    void _apply_dotlottie_manifest(const String &zip_path, const std::shared_ptr<const LottieManifest> &m, const std::shared_ptr<LottieArchive> &archive);
     String _extract_json_from_lottie_to_cache(const String &zip_path, const String &inner_path, const String &suffix_key);
     void _apply_selected_state_segment();
     String _current_state_segment_marker() const;
-    bool _find_marker_range(const String &json_path, const String &marker, float &out_begin, float &out_end) const;
-    void _start_worker_if_needed();
+    bool _find_marker_range(const String &marker, float &out_begin, float &out_end) const;
+    static std::shared_ptr<const LottieMarkerIndex> _index_markers(const String &source_path, const PackedByteArray &json);
+    void _schedule_worker_locked();
     void _stop_worker();
-    void _post_load_to_worker(const String& path);
+    void _post_load_to_worker(const String& path, tvg::Animation *parsed = nullptr);
+    bool _load_for_worker(const String &path, const PackedByteArray &json, WorkerLoadReply &r_reply);
+    bool _worker_owns_picture() const { return render_thread_enabled && single_picture_owner; }
+    bool _has_animation() const { return animation != nullptr || worker_picture_loaded; }
     void _post_render_to_worker(const Vector2i &size, float frame);
     void _post_segment_to_worker(float begin, float end);
-    void _worker_loop();
+    void _worker_run_jobs();
     void _worker_free_resources();
     void _worker_apply_target_if_needed(const Vector2i &size);
     void _worker_apply_fit_transform();
-    void _fix_alpha_border_rgba(uint8_t *rgba, int w, int h);
-    void _unpremultiply_alpha_rgba(uint8_t *rgba, int w, int h);
 
     bool segment_pending = false;
     float pending_segment_begin = 0.0f;
     float pending_segment_end = 0.0f;
+    // Last segment applied, so background bakes can reproduce it.
+    bool segment_active = false;
+    float segment_begin = 0.0f;
+    float segment_end = 0.0f;
+    // Absolute path ThorVG actually loaded (after any user:// mirroring), or the archive entry
+    // key when the JSON was read from a .lottie in memory; loaded_json then holds that JSON.
+    std::string loaded_path8;
+    PackedByteArray loaded_json;
+    // Markers of the loaded animation, scanned once per source and shared with other nodes.
+    std::shared_ptr<const LottieMarkerIndex> marker_index;
+
+    // Progress of a bake_frames() run; pool tasks share it and never touch the node.
+    struct BakeJob {
+        std::atomic<int> done{0};
+        std::atomic<int> failed{0};
+        std::atomic<bool> cancelled{false};
+        int total = 0;
+    };
+    std::shared_ptr<BakeJob> bake_job;
+    int bake_reported = -1;
+    void _poll_bake_progress();
+
+    // Sprite-sheet playback: baked atlas pages and one source rect per baked frame.
+    static constexpr int ATLAS_MAX_SIZE = 4096;
+    struct AtlasFrame {
+        int page = 0;
+        Rect2 rect;
+    };
+    std::vector<Ref<ImageTexture>> atlas_textures;
+    std::vector<AtlasFrame> atlas_frames;
+    float atlas_first_frame = 0.0f;
+    float atlas_last_frame = 0.0f; // last source frame the baked range covers
+    int atlas_frame_step = 1;
+    bool atlas_playback = false;
+    int atlas_drawn_index = -1;
+    bool _atlas_active() const { return atlas_playback && !atlas_frames.empty(); }
+    int _atlas_index_for_frame(float frame) const;
+    // bake_sprite_atlas() renders on the pool into pages owned by the job; _process() installs
+    // them once every chunk is done. Chunks write disjoint cells through page_ptrs.
+    struct AtlasBakeJob {
+        std::atomic<int> chunks_left{0};
+        std::atomic<bool> failed{false};
+        std::atomic<bool> cancelled{false};
+        std::vector<float> frames;
+        std::vector<AtlasFrame> rects;
+        std::vector<PackedByteArray> pages;
+        std::vector<Vector2i> page_sizes;
+        std::vector<uint8_t *> page_ptrs;
+        float first = 0.0f;
+        float last = 0.0f;
+        int frame_step = 1;
+    };
+    std::shared_ptr<AtlasBakeJob> atlas_job;
+    void _poll_atlas_bake();
+    void _cancel_atlas_bake();
+
+    // Shared-instance mode: nodes with the same animation, render size, state segment and alpha
+    // post-processing publish uploaded frames into a main-thread registry and reuse each other's
+    // textures per quantized frame.
+    bool shared_instance = false;
+    uint64_t shared_group = 0; // registry group joined (0 = none)
+    String shared_variant_key; // inputs behind shared_variant_id; re-interned only on change
+    uint32_t shared_variant_id = 0;
+    void _shared_sync_group();
+    void _shared_leave_group();
+    bool _shared_try_borrow(int qf);
+    bool _shared_pending_elsewhere(int qf) const;
+    void _shared_mark_pending(int qf);
+    bool _shared_publish(int qf);
+
+    // Per-frame render budget: requests go through LottieRenderScheduler when it is enabled.
+    friend class LottieRenderScheduler;
+    bool schedule_requested = false;
+    int schedule_skips = 0; // consecutive frames this node's render was deferred
+    double render_cost_ms = 1.0; // moving average of measured render cost
+    float render_focus = 1.0f; // user weight on top of screen coverage
+    std::atomic<float> worker_render_cost_ms{-1.0f}; // last worker render cost, folded in on the main thread
+    float _render_priority() const;
+    float _screen_coverage() const;
+    void _request_render();
+    void _run_scheduled_render();
+    void _on_render_skipped();
+    void _note_render_cost(double ms);
 
 protected:
     static void _bind_methods();
@@ -236,6 +448,8 @@ public:
     int get_culling_mode() const;
     void set_culling_margin_px(float p_margin);
     float get_culling_margin_px() const;
+    void set_single_picture_owner(bool p_enable);
+    bool is_single_picture_owner() const;
     
     void set_speed(float p_speed);
     float get_speed() const;
@@ -246,6 +460,27 @@ public:
     float get_duration() const;
     float get_total_frames() const;
     void render_static();
+    bool bake_frames(int from_frame, int to_frame, const Vector2i &size = Vector2i());
+    void cancel_bake();
+    bool is_baking() const;
+    bool bake_sprite_atlas(const Vector2i &frame_size, int frame_step = 1, const String &marker = String());
+    void clear_sprite_atlas();
+    Array get_atlas_textures() const;
+    Array get_atlas_frames() const;
+    void set_atlas_playback(bool p_enable);
+    bool is_atlas_playback() const;
+    void set_shared_instance(bool p_enable);
+    bool is_shared_instance() const;
+    void set_render_focus(float p_focus);
+    float get_render_focus() const;
+    void set_premultiplied_alpha(bool p_enable);
+    bool is_premultiplied_alpha() const;
+    void set_async_load(bool p_enable);
+    bool is_async_load() const;
+    void set_placeholder_texture(const Ref<Texture2D> &p_texture);
+    Ref<Texture2D> get_placeholder_texture() const;
+
+    static int64_t get_frame_buffer_allocations();
     
     void set_offset(const Vector2 &p_offset);
     Vector2 get_offset() const;
@@ -0,0 +1,72 @@
+#include "lottie_archive.h"
+#include <godot_cpp/classes/file_access.hpp>
+#include <unordered_map>
+
+using namespace godot;
+
+static std::mutex g_archives_mutex;
+static std::unordered_map<std::string, std::weak_ptr<LottieArchive>> g_archives;
+
+LottieArchive::Stamp LottieArchive::stamp_of(const String &path) {
+    Stamp stamp;
+    stamp.mtime = FileAccess::get_modified_time(path);
+    Ref<FileAccess> f = FileAccess::open(path, FileAccess::READ);
+    if (f.is_null()) return stamp;
+    stamp.size = (int64_t)f->get_length();
+    f->close();
+    return stamp;
+}
+
+std::shared_ptr<LottieArchive> LottieArchive::open(const String &path) {
+    if (path.is_empty()) return nullptr;
+    const std::string key = path.utf8().get_data();
+    const Stamp stamp = stamp_of(path);
+    std::lock_guard<std::mutex> lk(g_archives_mutex);
+    auto it = g_archives.find(key);
+    if (it != g_archives.end()) {
+        std::shared_ptr<LottieArchive> live = it->second.lock();
+        // A changed file gets a new archive; holders keep the old handle until they drop it.
+        if (live && live->_stamp == stamp) return live;
+        g_archives.erase(it);
+    }
+    std::shared_ptr<LottieArchive> archive(new LottieArchive());
+    if (!archive->_open(path)) return nullptr;
+    archive->_stamp = stamp;
+    // Drop entries whose archives have closed so the registry stays as small as the live set.
+    for (auto e = g_archives.begin(); e != g_archives.end();) {
+        if (e->second.expired()) e = g_archives.erase(e);
+        else ++e;
+    }
+    g_archives[key] = archive;
+    return archive;
+}
+
+void LottieArchive::clear_cache() {
+    std::lock_guard<std::mutex> lk(g_archives_mutex);
+    g_archives.clear();
+}
+
+bool LottieArchive::_open(const String &path) {
+    _reader.instantiate();
+    if (_reader.is_null() || _reader->open(path) != OK) {
+        _reader.unref();
+        return false;
+    }
+    _path = path;
+    _files = _reader->get_files();
+    _index.reserve((size_t)_files.size());
+    for (int i = 0; i < _files.size(); i++) {
+        _index.insert(std::string(_files[i].utf8().get_data()));
+    }
+    return true;
+}
+
+bool LottieArchive::has_file(const String &entry) const {
+    return _index.count(std::string(entry.utf8().get_data())) != 0;
+}
+
+PackedByteArray LottieArchive::read_file(const String &entry) {
+    if (!has_file(entry)) return PackedByteArray();
+    std::lock_guard<std::mutex> lk(_read_mutex);
+    return _reader->read_file(entry);
+}
@@ -0,0 +1,56 @@
+#ifndef LOTTIE_ARCHIVE_H
+#define LOTTIE_ARCHIVE_H
+
+#include <godot_cpp/classes/zip_reader.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <godot_cpp/variant/packed_string_array.hpp>
+#include <godot_cpp/variant/string.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+namespace godot {
+
+// Open .lottie (zip) bundle shared by every concurrent load of the same path: the central
+// directory is read once and entries are served from the one open handle, so manifest,
+// state-machine and animation lookups cost a read each instead of an open each. The registry
+// only holds weak references, so the file handle closes when the last user drops the archive.
+// The archive is reopened when the file's size or mtime changes. Reads are serialized and safe
+// from any thread.
+class LottieArchive {
+public:
+    // Size and mtime of a bundle file; identifies the contents an archive was opened on.
+    struct Stamp {
+        int64_t size = -1;
+        uint64_t mtime = 0;
+        bool operator==(const Stamp &o) const { return size == o.size && mtime == o.mtime; }
+        bool operator!=(const Stamp &o) const { return !(*this == o); }
+    };
+    static Stamp stamp_of(const String &path);
+
+    // Shared archive for `path`, or null when it cannot be opened as a zip.
+    static std::shared_ptr<LottieArchive> open(const String &path);
+    // Forgets every registered archive (module shutdown); open holders keep theirs.
+    static void clear_cache();
+
+    const String &get_path() const { return _path; }
+    const Stamp &get_stamp() const { return _stamp; }
+    const PackedStringArray &get_files() const { return _files; }
+    bool has_file(const String &entry) const;
+    PackedByteArray read_file(const String &entry);
+
+private:
+    String _path;
+    Stamp _stamp;
+    Ref<ZIPReader> _reader;
+    PackedStringArray _files;
+    std::unordered_set<std::string> _index;
+    std::mutex _read_mutex; // ZIPReader keeps one file cursor
+
+    bool _open(const String &path);
+};
+
+}
+
+#endif
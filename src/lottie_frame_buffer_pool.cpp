@@ -0,0 +1,58 @@
+#include "lottie_frame_buffer_pool.h"
+#include <godot_cpp/core/memory.hpp>
+
+using namespace godot;
+
+static LottieFrameBufferPool *singleton = nullptr;
+
+void LottieFrameBufferPool::initialize() {
+    if (!singleton) singleton = memnew(LottieFrameBufferPool);
+}
+
+void LottieFrameBufferPool::shutdown() {
+    if (!singleton) return;
+    memdelete(singleton);
+    singleton = nullptr;
+}
+
+LottieFrameBufferPool *LottieFrameBufferPool::get_singleton() {
+    return singleton;
+}
+
+PackedByteArray LottieFrameBufferPool::acquire(int64_t bytes) {
+    if (bytes <= 0) return PackedByteArray();
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        auto it = _free.find(bytes);
+        if (it != _free.end() && !it->second.empty()) {
+            PackedByteArray buf = it->second.back();
+            it->second.pop_back();
+            _free_bytes -= (size_t)bytes;
+            return buf;
+        }
+    }
+    PackedByteArray buf;
+    buf.resize(bytes);
+    _allocations.fetch_add(1, std::memory_order_relaxed);
+    return buf;
+}
+
+void LottieFrameBufferPool::release(PackedByteArray &buffer) {
+    const int64_t bytes = buffer.size();
+    if (bytes > 0) {
+        std::lock_guard<std::mutex> lk(_mutex);
+        std::vector<PackedByteArray> &bucket = _free[bytes];
+        // Beyond the limits the buffer is simply dropped (freed when the last reference goes).
+        if (bucket.size() < _max_per_size && _free_bytes + (size_t)bytes <= _max_free_bytes) {
+            bucket.push_back(buffer);
+            _free_bytes += (size_t)bytes;
+        }
+    }
+    buffer = PackedByteArray();
+}
+
+void LottieFrameBufferPool::clear() {
+    std::lock_guard<std::mutex> lk(_mutex);
+    _free.clear();
+    _free_bytes = 0;
+}
@@ -0,0 +1,43 @@
+#ifndef LOTTIE_FRAME_BUFFER_POOL_H
+#define LOTTIE_FRAME_BUFFER_POOL_H
+
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <unordered_map>
+#include <vector>
+#include <mutex>
+#include <atomic>
+
+namespace godot {
+
+// Process-wide free list of RGBA frame buffers, bucketed by byte size.
+// Buffers travel worker -> main thread -> back here once the upload no longer
+// references them, so steady-state playback does not touch the heap.
+// A released buffer must not be shared with anything else, otherwise the next
+// ptrw() on it would silently copy (copy-on-write).
+class LottieFrameBufferPool {
+public:
+    // Created and destroyed with the extension module, so worker threads never race to create it.
+    static void initialize();
+    static void shutdown();
+    static LottieFrameBufferPool *get_singleton();
+
+    PackedByteArray acquire(int64_t bytes);
+    // Returns the buffer to the free list and clears the caller's reference.
+    void release(PackedByteArray &buffer);
+    void clear();
+
+    // Number of buffers allocated because no free buffer of the requested size was available.
+    uint64_t get_allocation_count() const { return _allocations.load(std::memory_order_relaxed); }
+
+private:
+    std::mutex _mutex;
+    std::unordered_map<int64_t, std::vector<PackedByteArray>> _free;
+    size_t _free_bytes = 0;
+    size_t _max_free_bytes = 64 * 1024 * 1024;
+    size_t _max_per_size = 4;
+    std::atomic<uint64_t> _allocations{0};
+};
+
+}
+
+#endif
@@ -1,70 +1,489 @@
 #include "lottie_frame_cache.h"
-#include <godot_cpp/variant/utility_functions.hpp>
+#include "lottie_frame_buffer_pool.h"
+#include "lottie_frame_codec.h"
+#include "lottie_render_pool.h"
+#include <godot_cpp/core/memory.hpp>
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/dir_access.hpp>
+#include <godot_cpp/classes/project_settings.hpp>
+#include <algorithm>
+#include <cstring>
+#include <vector>
 
 using namespace godot;
 
 static LottieFrameCache *singleton = nullptr;
 
+static const char *DISK_DIR = "user://lottie_cache/frames";
+
+// Container layout: a 16-byte header ("LFC2", width, height, reserved), followed by records
+// padded to 16 bytes, each a 16-byte header ("LFRM", frame, stored byte count, encoding) and
+// the frame as a LottieFrameCodec stream, or as raw RGBA8 when it did not compress. A record
+// cut short by a crash ends the scan and is overwritten by the next write.
+static const uint32_t DISK_FILE_MAGIC = 0x3243464Cu;   // "LFC2"
+static const uint32_t DISK_RECORD_MAGIC = 0x4D52464Cu; // "LFRM"
+static const uint64_t DISK_HEADER = 16;
+static const uint32_t DISK_RAW = 0;
+static const uint32_t DISK_RLE = 1;
+
+// Bytes of frames the disk writer may hold before further writes are dropped.
+static const size_t DISK_QUEUE_BYTES = 64 * 1024 * 1024;
+// Without a render pool, queued writes are drained on the caller's thread this many at a time.
+static const size_t DISK_SYNC_BATCH = 8;
+
+static inline uint64_t _pad16(uint64_t n) {
+    return (n + 15) & ~(uint64_t)15;
+}
+
+// Run-length encodes a frame into r_stream; returns false, leaving r_stream untouched, when the
+// stream would not be at least 1/8 smaller than the raw frame (noisy, fully opaque content).
+static bool _encode_frame(const PackedByteArray &rgba, PackedByteArray &r_stream) {
+    thread_local std::vector<uint8_t> scratch;
+    const size_t size = (size_t)rgba.size();
+    scratch.resize(size - size / 8);
+    const size_t packed = LottieFrameCodec::encode(rgba.ptr(), size / 4, scratch.data(), scratch.size());
+    if (packed == 0) return false;
+    r_stream.resize((int64_t)packed);
+    memcpy(r_stream.ptrw(), scratch.data(), packed);
+    return true;
+}
+
+struct LottieFrameCache::DiskContainer {
+    struct Record {
+        uint64_t offset;
+        uint32_t bytes;
+        uint32_t encoding;
+    };
+
+    std::mutex mutex;
+    std::string name;
+    Ref<FileAccess> file;
+    uint64_t frame_bytes = 0;
+    uint64_t end = DISK_HEADER;
+    std::unordered_map<int, Record> index;
+
+    bool open(const String &path, const Vector2i &size) {
+        frame_bytes = (uint64_t)size.x * (uint64_t)size.y * 4;
+        if (FileAccess::file_exists(path)) {
+            file = FileAccess::open(path, FileAccess::READ_WRITE);
+            if (file.is_valid() && file->get_32() == DISK_FILE_MAGIC && (int)file->get_32() == size.x && (int)file->get_32() == size.y) {
+                _scan();
+                return true;
+            }
+            file.unref();
+        }
+        // Missing or foreign file (including the uncompressed LFC1 layout): start afresh.
+        file = FileAccess::open(path, FileAccess::WRITE_READ);
+        if (file.is_null()) return false;
+        file->store_32(DISK_FILE_MAGIC);
+        file->store_32((uint32_t)size.x);
+        file->store_32((uint32_t)size.y);
+        file->store_32(0);
+        return true;
+    }
+
+    void close() {
+        file.unref();
+        index.clear();
+    }
+
+    void _scan() {
+        const uint64_t len = file->get_length();
+        uint64_t off = DISK_HEADER;
+        while (off + DISK_HEADER <= len) {
+            file->seek(off);
+            if (file->get_32() != DISK_RECORD_MAGIC) break;
+            const int frame = (int)file->get_32();
+            const uint32_t bytes = file->get_32();
+            const uint32_t encoding = file->get_32();
+            if (encoding == DISK_RAW ? bytes != frame_bytes : (encoding != DISK_RLE || bytes == 0 || bytes > frame_bytes)) break;
+            if (off + DISK_HEADER + bytes > len) break;
+            index[frame] = Record{ off, bytes, encoding };
+            off += DISK_HEADER + _pad16(bytes);
+        }
+        end = off;
+    }
+
+    bool has(int frame) const {
+        return file.is_valid() && index.count(frame) != 0;
+    }
+
+    // Returns the stored record; r_encoded tells whether it still needs LottieFrameCodec::decode.
+    bool read(int frame, PackedByteArray &r_data, bool &r_encoded) {
+        if (file.is_null()) return false;
+        auto it = index.find(frame);
+        if (it == index.end()) return false;
+        file->seek(it->second.offset + DISK_HEADER);
+        r_data = file->get_buffer((int64_t)it->second.bytes);
+        r_encoded = it->second.encoding == DISK_RLE;
+        return (uint64_t)r_data.size() == it->second.bytes;
+    }
+
+    // Appends a record without flushing; the writer flushes once per batch.
+    void write(int frame, const PackedByteArray &data, uint32_t encoding) {
+        if (file.is_null() || index.count(frame)) return;
+        const uint64_t bytes = (uint64_t)data.size();
+        file->seek(end);
+        file->store_32(DISK_RECORD_MAGIC);
+        file->store_32((uint32_t)frame);
+        file->store_32((uint32_t)bytes);
+        file->store_32(encoding);
+        file->store_buffer(data);
+        for (uint64_t pad = bytes; pad < _pad16(bytes); ++pad) file->store_8(0);
+        index[frame] = Record{ end, (uint32_t)bytes, encoding };
+        end += DISK_HEADER + _pad16(bytes);
+    }
+};
+
+LottieFrameCache::~LottieFrameCache() {
+    // The render pool is already gone at module shutdown; finish queued writes here.
+    _drain_disk_writes();
+}
+
+void LottieFrameCache::initialize() {
+    if (singleton) return;
+    singleton = memnew(LottieFrameCache);
+    ProjectSettings *ps = ProjectSettings::get_singleton();
+    if (ps && ps->has_setting("lottie/frame_cache/disk_enabled")) {
+        singleton->_disk_enabled = (bool)ps->get_setting("lottie/frame_cache/disk_enabled");
+    }
+    if (ps && ps->has_setting("lottie/frame_cache/disk_budget_mb")) {
+        singleton->_disk_budget = (uint64_t)std::max<int64_t>(16, (int64_t)ps->get_setting("lottie/frame_cache/disk_budget_mb")) * 1024ull * 1024ull;
+    }
+    if (ps && ps->has_setting("lottie/frame_cache/compress")) {
+        singleton->_compress = (bool)ps->get_setting("lottie/frame_cache/compress");
+    }
+}
+
+void LottieFrameCache::shutdown() {
+    if (!singleton) return;
+    memdelete(singleton);
+    singleton = nullptr;
+}
+
 LottieFrameCache *LottieFrameCache::get_singleton() {
-    if (!singleton) singleton = memnew(LottieFrameCache);
     return singleton;
 }
 
-Ref<ImageTexture> LottieFrameCache::get(const String &anim_key, int frame, const Vector2i &size) {
-    Key key{anim_key, frame, size.x, size.y};
-    auto it = _map.find(key);
-    if (it == _map.end()) return Ref<ImageTexture>();
-    _touch(key);
-    return it->second.tex;
+void LottieFrameCache::set_content_hash(uint32_t anim_id, const String &content_hash) {
+    if (anim_id == 0 || content_hash.is_empty()) return;
+    std::lock_guard<std::mutex> lk(_disk_mutex);
+    _content_hashes[anim_id] = content_hash.utf8().get_data();
 }
 
-void LottieFrameCache::put(const String &anim_key, int frame, const Vector2i &size, const Ref<ImageTexture> &tex, size_t bytes) {
-    if (bytes == 0 || tex.is_null()) return;
-    Key key{anim_key, frame, size.x, size.y};
-    auto it = _map.find(key);
-    if (it != _map.end()) {
-        // Replace and adjust usage
-        _used -= it->second.bytes;
-        it->second.tex = tex;
-        it->second.bytes = bytes;
-        _used += bytes;
-        _touch(key);
+std::shared_ptr<LottieFrameCache::DiskContainer> LottieFrameCache::_container_for(uint32_t anim_id, const Vector2i &size) {
+    if (!_disk_enabled || size.x <= 0 || size.y <= 0) return nullptr;
+    std::lock_guard<std::mutex> lk(_disk_mutex);
+    auto hit = _content_hashes.find(anim_id);
+    if (hit == _content_hashes.end()) return nullptr;
+    const std::string name = hit->second + "_" + std::to_string(size.x) + "x" + std::to_string(size.y);
+    _list_disk_locked();
+    auto it = _containers.find(name);
+    if (it != _containers.end()) {
+        if (it->second) _disk_files[name].last_used = ++_disk_clock;
+        return it->second;
+    }
+
+    std::shared_ptr<DiskContainer> c = std::make_shared<DiskContainer>();
+    c->name = name;
+    if (c->open(String(DISK_DIR).path_join(String::utf8(name.c_str()) + ".lfc"), size)) {
+        DiskFile &f = _disk_files[name];
+        _disk_used = _disk_used - f.size + c->end;
+        f.size = c->end;
+        f.last_used = ++_disk_clock;
+    } else {
+        c.reset();
+    }
+    _containers.emplace(name, c); // a failed open is remembered as nullptr
+    return c;
+}
+
+void LottieFrameCache::_list_disk_locked() {
+    // Caller holds _disk_mutex. Containers left by earlier launches count against the budget
+    // too; they rank by modification time, below everything used in this session.
+    if (_disk_listed) return;
+    _disk_listed = true;
+    const String dir = ProjectSettings::get_singleton()->globalize_path(DISK_DIR);
+    DirAccess::make_dir_recursive_absolute(dir);
+    const PackedStringArray files = DirAccess::get_files_at(dir);
+    for (int64_t i = 0; i < files.size(); ++i) {
+        const String &file_name = files[i];
+        if (file_name.get_extension() != "lfc") continue;
+        const String path = dir.path_join(file_name);
+        Ref<FileAccess> f = FileAccess::open(path, FileAccess::READ);
+        if (f.is_null()) continue;
+        DiskFile &entry = _disk_files[std::string(file_name.get_basename().utf8().get_data())];
+        entry.size = f->get_length();
+        entry.last_used = FileAccess::get_modified_time(path);
+        _disk_used += entry.size;
+        _disk_clock = std::max(_disk_clock, entry.last_used);
+    }
+}
+
+void LottieFrameCache::_queue_disk_write(const std::shared_ptr<DiskContainer> &disk, int frame, const PackedByteArray &rgba) {
+    bool schedule = false;
+    bool drain_now = false;
+    {
+        std::lock_guard<std::mutex> lk(_write_mutex);
+        // The writer is behind: this frame stays memory-only rather than growing the queue.
+        if (_write_bytes + (size_t)rgba.size() > DISK_QUEUE_BYTES) return;
+        _writes.push_back(DiskWrite{ disk, frame, rgba });
+        _write_bytes += (size_t)rgba.size();
+        if (LottieRenderPool::has_singleton()) {
+            schedule = !_write_scheduled;
+            _write_scheduled = true;
+        } else {
+            drain_now = _writes.size() >= DISK_SYNC_BATCH;
+        }
+    }
+    if (schedule) {
+        LottieRenderPool::get_singleton()->submit(this, [this]() { _drain_disk_writes(); });
+    } else if (drain_now) {
+        _drain_disk_writes();
+    }
+}
+
+void LottieFrameCache::_drain_disk_writes() {
+    while (true) {
+        std::vector<DiskWrite> batch;
+        {
+            std::lock_guard<std::mutex> lk(_write_mutex);
+            if (_writes.empty()) {
+                _write_scheduled = false;
+                return;
+            }
+            batch.swap(_writes);
+            _write_bytes = 0;
+        }
+
+        std::vector<std::shared_ptr<DiskContainer>> touched;
+        for (DiskWrite &w : batch) {
+            {
+                std::lock_guard<std::mutex> lk(w.disk->mutex);
+                if (w.disk->has(w.frame) || w.disk->file.is_null()) continue;
+            }
+            // Encode outside the container lock so readers are not held up.
+            PackedByteArray stream;
+            const bool encoded = _encode_frame(w.rgba, stream);
+            {
+                std::lock_guard<std::mutex> lk(w.disk->mutex);
+                w.disk->write(w.frame, encoded ? stream : w.rgba, encoded ? DISK_RLE : DISK_RAW);
+            }
+            if (std::find(touched.begin(), touched.end(), w.disk) == touched.end()) touched.push_back(w.disk);
+        }
+        batch.clear();
+
+        // One flush per container per batch instead of one per frame.
+        std::vector<std::pair<std::string, uint64_t>> sizes;
+        for (const std::shared_ptr<DiskContainer> &c : touched) {
+            std::lock_guard<std::mutex> lk(c->mutex);
+            if (c->file.is_null()) continue;
+            c->file->flush();
+            sizes.emplace_back(c->name, c->end);
+        }
+        std::lock_guard<std::mutex> lk(_disk_mutex);
+        for (const auto &s : sizes) {
+            DiskFile &f = _disk_files[s.first];
+            _disk_used = _disk_used - f.size + s.second;
+            f.size = s.second;
+            f.last_used = ++_disk_clock;
+        }
+        _evict_disk_locked(sizes);
+    }
+}
+
+void LottieFrameCache::_evict_disk_locked(const std::vector<std::pair<std::string, uint64_t>> &busy) {
+    // Caller holds _disk_mutex. Removes whole containers, least recently used first, until the
+    // folder fits the budget; the containers just written are kept so they cannot thrash.
+    const String dir = ProjectSettings::get_singleton()->globalize_path(DISK_DIR);
+    while (_disk_used > _disk_budget) {
+        auto victim = _disk_files.end();
+        for (auto it = _disk_files.begin(); it != _disk_files.end(); ++it) {
+            const bool is_busy = std::any_of(busy.begin(), busy.end(), [&](const std::pair<std::string, uint64_t> &b) { return b.first == it->first; });
+            if (!is_busy && (victim == _disk_files.end() || it->second.last_used < victim->second.last_used)) victim = it;
+        }
+        if (victim == _disk_files.end()) break;
+        auto open = _containers.find(victim->first);
+        if (open != _containers.end()) {
+            // Holders of this container now see misses; the next use starts a fresh file.
+            if (open->second) {
+                std::lock_guard<std::mutex> lk(open->second->mutex);
+                open->second->close();
+            }
+            _containers.erase(open);
+        }
+        DirAccess::remove_absolute(dir.path_join(String::utf8(victim->first.c_str()) + ".lfc"));
+        _disk_used -= std::min(_disk_used, victim->second.size);
+        _disk_files.erase(victim);
+    }
+}
+
+uint32_t LottieFrameCache::intern(const String &anim_key) {
+    std::string k(anim_key.utf8().get_data());
+    std::lock_guard<std::mutex> lk(_intern_mutex);
+    auto it = _ids.find(k);
+    if (it != _ids.end()) return it->second;
+    uint32_t id = _next_id++;
+    _ids.emplace(std::move(k), id);
+    return id;
+}
+
+LottieFrameCache::Shard &LottieFrameCache::_shard_for(const Key &key) {
+    return _shards[Key::Hasher()(key) % SHARD_COUNT];
+}
+
+bool LottieFrameCache::get(uint32_t anim_id, int frame, const Vector2i &size, PackedByteArray &r_rgba, bool *r_owned) {
+    if (r_owned) *r_owned = false;
+    Key key{anim_id, frame, size.x, size.y};
+    Shard &shard = _shard_for(key);
+    PackedByteArray packed;
+    size_t raw_bytes = 0;
+    {
+        std::lock_guard<std::mutex> lk(shard.mutex);
+        auto it = shard.map.find(key);
+        if (it != shard.map.end()) {
+            // Touch
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second.lru_it);
+            packed = it->second.rgba;
+            raw_bytes = it->second.raw_bytes;
+            if (raw_bytes == 0) {
+                r_rgba = packed;
+                return true;
+            }
+        }
+    }
+    if (raw_bytes != 0) {
+        // Decode outside the shard lock; the shared stream stays valid copy-on-write.
+        LottieFrameBufferPool *pool = LottieFrameBufferPool::get_singleton();
+        r_rgba = pool->acquire((int64_t)raw_bytes);
+        if (!LottieFrameCodec::decode(packed.ptr(), (size_t)packed.size(), r_rgba.ptrw(), raw_bytes / 4)) {
+            pool->release(r_rgba);
+            return false;
+        }
+        if (r_owned) *r_owned = true;
+        return true;
+    }
+    std::shared_ptr<DiskContainer> disk = _container_for(anim_id, size);
+    if (!disk) return false;
+    PackedByteArray record;
+    bool encoded = false;
+    {
+        std::lock_guard<std::mutex> lk(disk->mutex);
+        if (!disk->read(frame, record, encoded)) return false;
+    }
+    if (!encoded) {
+        r_rgba = record;
+        _insert(key, r_rgba);
+        return true;
+    }
+    const size_t frame_bytes = (size_t)size.x * (size_t)size.y * 4;
+    LottieFrameBufferPool *pool = LottieFrameBufferPool::get_singleton();
+    r_rgba = pool->acquire((int64_t)frame_bytes);
+    if (!LottieFrameCodec::decode(record.ptr(), (size_t)record.size(), r_rgba.ptrw(), frame_bytes / 4)) {
+        pool->release(r_rgba);
+        return false;
+    }
+    if (_compress) {
+        // The record is already in the memory tier's format, and the decoded frame stays private.
+        _store(key, record, frame_bytes);
+        if (r_owned) *r_owned = true;
+    } else {
+        _store(key, r_rgba, 0);
+    }
+    return true;
+}
+
+void LottieFrameCache::put(uint32_t anim_id, int frame, const Vector2i &size, const PackedByteArray &rgba) {
+    if (rgba.is_empty() || anim_id == 0) return;
+    Key key{anim_id, frame, size.x, size.y};
+    _insert(key, rgba);
+    std::shared_ptr<DiskContainer> disk = _container_for(anim_id, size);
+    if (disk) {
+        {
+            std::lock_guard<std::mutex> lk(disk->mutex);
+            if (disk->has(frame)) return;
+        }
+        _queue_disk_write(disk, frame, rgba);
+    }
+}
+
+void LottieFrameCache::_insert(const Key &key, const PackedByteArray &rgba) {
+    PackedByteArray stream;
+    if (_compress && _encode_frame(rgba, stream)) {
+        _store(key, stream, (size_t)rgba.size());
     } else {
-        _lru.push_front(key);
-        Entry e; e.tex = tex; e.bytes = bytes; e.lru_it = _lru.begin();
-        _map.emplace(key, e);
+        _store(key, rgba, 0);
+    }
+}
+
+void LottieFrameCache::_store(const Key &key, const PackedByteArray &stored, size_t raw_bytes) {
+    const size_t bytes = (size_t)stored.size();
+    Shard &shard = _shard_for(key);
+    {
+        std::lock_guard<std::mutex> lk(shard.mutex);
+        auto it = shard.map.find(key);
+        if (it != shard.map.end()) {
+            // Replace and adjust usage
+            shard.used -= it->second.bytes;
+            _used -= it->second.bytes;
+            it->second.rgba = stored;
+            it->second.raw_bytes = raw_bytes;
+            it->second.bytes = bytes;
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second.lru_it);
+        } else {
+            shard.lru.push_front(key);
+            Entry e; e.rgba = stored; e.raw_bytes = raw_bytes; e.bytes = bytes; e.lru_it = shard.lru.begin();
+            shard.map.emplace(key, e);
+        }
+        shard.used += bytes;
         _used += bytes;
+        // Older entries of this shard go first; the one just inserted is kept.
+        _evict_from(shard, 1);
     }
     _evict_if_needed();
 }
 
 void LottieFrameCache::set_capacity_bytes(size_t bytes) {
-    _capacity = bytes;
+    if (_capacity.exchange(bytes) == bytes) return;
     _evict_if_needed();
 }
 
 void LottieFrameCache::clear() {
-    _map.clear();
-    _lru.clear();
-    _used = 0;
+    for (Shard &shard : _shards) {
+        std::lock_guard<std::mutex> lk(shard.mutex);
+        shard.map.clear();
+        shard.lru.clear();
+        _used -= shard.used;
+        shard.used = 0;
+    }
 }
 
-void LottieFrameCache::_touch(const Key &key) {
-    auto it = _map.find(key);
-    if (it == _map.end()) return;
-    _lru.erase(it->second.lru_it);
-    _lru.push_front(key);
-    it->second.lru_it = _lru.begin();
+void LottieFrameCache::_evict_from(Shard &shard, size_t keep) {
+    // Caller holds shard.mutex. Evicts this shard's LRU tail while the whole cache is over budget.
+    while (_used.load() > _capacity.load() && shard.lru.size() > keep) {
+        const Key &old = shard.lru.back();
+        auto it = shard.map.find(old);
+        if (it != shard.map.end()) {
+            shard.used -= it->second.bytes;
+            _used -= it->second.bytes;
+            shard.map.erase(it);
+        }
+        shard.lru.pop_back();
+    }
 }
 
 void LottieFrameCache::_evict_if_needed() {
-    while (_used > _capacity && !_lru.empty()) {
-        const Key &old = _lru.back();
-        auto it = _map.find(old);
-        if (it != _map.end()) {
-            _used -= it->second.bytes;
-            _map.erase(it);
+    // The budget is global: a shard may hold more than its share while the total fits. When over,
+    // take one entry at a time from shards in round-robin order, giving up after a full empty pass.
+    int idle = 0;
+    while (_used.load() > _capacity.load() && idle < SHARD_COUNT) {
+        Shard &shard = _shards[_evict_cursor.fetch_add(1) % SHARD_COUNT];
+        std::lock_guard<std::mutex> lk(shard.mutex);
+        if (shard.lru.empty()) {
+            idle++;
+            continue;
         }
-        _lru.pop_back();
+        idle = 0;
+        _evict_from(shard, shard.lru.size() - 1);
     }
 }
@@ -1,55 +1,143 @@
 #ifndef LOTTIE_FRAME_CACHE_H
 #define LOTTIE_FRAME_CACHE_H
 
-#include <godot_cpp/classes/image.hpp>
-#include <godot_cpp/classes/image_texture.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
 #include <godot_cpp/variant/string.hpp>
+#include <godot_cpp/variant/vector2i.hpp>
 #include <unordered_map>
 #include <list>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <memory>
 
 namespace godot {
 
+// Process-wide LRU cache of CPU-side RGBA frames, safe to use from render workers.
+// Entries are spread over lock-striped shards so concurrent workers rarely contend; the byte
+// budget is shared by all shards rather than split between them.
+// Pixels are stored as PackedByteArray and shared copy-on-write with callers, so a
+// returned frame must never be written to or recycled into LottieFrameBufferPool, unless
+// get() reports it as owned.
+//
+// An optional disk tier (lottie/frame_cache/disk_enabled) persists frames across launches
+// under user://lottie_cache/frames, one append-only container per (content hash, size).
+// Records are run-length encoded and written in batches by a background task on the render
+// pool; whole containers are evicted least recently used first to keep the folder within
+// lottie/frame_cache/disk_budget_mb.
+//
+// With lottie/frame_cache/compress, memory entries are kept run-length encoded
+// (LottieFrameCodec) and charged at their compressed size; mostly flat, transparent frames
+// shrink several times over. Hits are decoded into pooled buffers.
 class LottieFrameCache {
 public:
+    // Created and destroyed with the extension module, so worker threads never race to create it.
+    static void initialize();
+    static void shutdown();
     static LottieFrameCache *get_singleton();
+    ~LottieFrameCache();
 
-    Ref<ImageTexture> get(const String &anim_key, int frame, const Vector2i &size);
-    void put(const String &anim_key, int frame, const Vector2i &size, const Ref<ImageTexture> &tex, size_t bytes);
+    // Maps an animation key to a compact id; the same key always yields the same id.
+    uint32_t intern(const String &anim_key);
+
+    // Associates an animation id with a hash of its source content; frames of ids without
+    // one are never written to disk.
+    void set_content_hash(uint32_t anim_id, const String &content_hash);
+    bool is_disk_enabled() const { return _disk_enabled; }
+    void set_compression_enabled(bool enabled) { _compress = enabled; }
+    bool is_compression_enabled() const { return _compress; }
+
+    // With r_owned set on return, r_rgba was decoded into a LottieFrameBufferPool buffer that
+    // only the caller holds and may recycle; otherwise it is shared with the cache.
+    bool get(uint32_t anim_id, int frame, const Vector2i &size, PackedByteArray &r_rgba, bool *r_owned = nullptr);
+    void put(uint32_t anim_id, int frame, const Vector2i &size, const PackedByteArray &rgba);
     void set_capacity_bytes(size_t bytes);
     void clear();
 
 private:
+    static constexpr int SHARD_COUNT = 16;
+
     struct Key {
-        String anim;
+        uint32_t anim;
         int frame;
         int w;
         int h;
         bool operator==(const Key &o) const {
-            return frame == o.frame && w == o.w && h == o.h && anim == o.anim;
+            return anim == o.anim && frame == o.frame && w == o.w && h == o.h;
         }
         struct Hasher {
             size_t operator()(const Key &k) const {
-                std::hash<std::string> hs;
-                size_t h1 = hs(std::string(k.anim.utf8().get_data()));
-                size_t h2 = ((size_t)k.frame << 1) ^ ((size_t)k.w << 17) ^ ((size_t)k.h << 29);
-                return h1 ^ h2;
+                uint64_t h = (uint64_t)k.anim * 0x9E3779B97F4A7C15ull;
+                h ^= (uint64_t)(uint32_t)k.frame + 0x9E3779B9ull + (h << 6) + (h >> 2);
+                h ^= ((uint64_t)(uint32_t)k.w << 32 | (uint32_t)k.h) + (h << 6) + (h >> 2);
+                return (size_t)h;
             }
         };
     };
 
     struct Entry {
-        Ref<ImageTexture> tex;
+        PackedByteArray rgba; // LottieFrameCodec stream when raw_bytes != 0
+        size_t raw_bytes = 0;
         size_t bytes = 0;
         std::list<Key>::iterator lru_it;
     };
 
-    std::unordered_map<Key, Entry, Key::Hasher> _map;
-    std::list<Key> _lru;
-    size_t _capacity = 256 * 1024 * 1024;
-    size_t _used = 0;
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<Key, Entry, Key::Hasher> map;
+        std::list<Key> lru;
+        size_t used = 0;
+    };
+
+    Shard _shards[SHARD_COUNT];
+    std::atomic<size_t> _capacity{256 * 1024 * 1024};
+    std::atomic<size_t> _used{0};
+    std::atomic<uint32_t> _evict_cursor{0};
+    std::atomic<bool> _compress{false};
+
+    std::mutex _intern_mutex;
+    std::unordered_map<std::string, uint32_t> _ids;
+    uint32_t _next_id = 1;
+
+    // One open container file; all access goes through its mutex. Lock order: _disk_mutex,
+    // then a container's mutex.
+    struct DiskContainer;
+    struct DiskFile {
+        uint64_t size = 0;
+        uint64_t last_used = 0;
+    };
+    bool _disk_enabled = false;
+    std::mutex _disk_mutex;
+    std::unordered_map<uint32_t, std::string> _content_hashes;
+    std::unordered_map<std::string, std::shared_ptr<DiskContainer>> _containers;
+    std::unordered_map<std::string, DiskFile> _disk_files; // every container in the folder, by name
+    bool _disk_listed = false;
+    uint64_t _disk_used = 0;
+    uint64_t _disk_budget = 512ull * 1024 * 1024;
+    uint64_t _disk_clock = 0;
+
+    // Frames waiting for the disk writer; they share pixels with the memory tier.
+    struct DiskWrite {
+        std::shared_ptr<DiskContainer> disk;
+        int frame;
+        PackedByteArray rgba;
+    };
+    std::mutex _write_mutex;
+    std::vector<DiskWrite> _writes;
+    size_t _write_bytes = 0;
+    bool _write_scheduled = false;
 
-    void _touch(const Key &key);
+    Shard &_shard_for(const Key &key);
+    void _evict_from(Shard &shard, size_t keep);
     void _evict_if_needed();
+    void _insert(const Key &key, const PackedByteArray &rgba);
+    void _store(const Key &key, const PackedByteArray &stored, size_t raw_bytes);
+    std::shared_ptr<DiskContainer> _container_for(uint32_t anim_id, const Vector2i &size);
+    void _list_disk_locked();
+    void _queue_disk_write(const std::shared_ptr<DiskContainer> &disk, int frame, const PackedByteArray &rgba);
+    void _drain_disk_writes();
+    void _evict_disk_locked(const std::vector<std::pair<std::string, uint64_t>> &busy);
 };
 
 }
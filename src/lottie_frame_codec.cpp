@@ -0,0 +1,106 @@
+#include "lottie_frame_codec.h"
+#include <cstring>
+
+using namespace godot;
+
+// Shorter repeats cost more as a run token than inside the surrounding literal.
+static const size_t MIN_RUN = 3;
+
+static inline uint32_t _load(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static inline size_t _header_size(uint64_t h) {
+    size_t n = 1;
+    while (h >= 0x80) {
+        h >>= 7;
+        n++;
+    }
+    return n;
+}
+
+// Writes one token header; returns false when it does not fit.
+static inline bool _put_header(uint8_t *dst, size_t capacity, size_t &pos, uint64_t h) {
+    if (pos + _header_size(h) > capacity) return false;
+    while (h >= 0x80) {
+        dst[pos++] = (uint8_t)(h | 0x80);
+        h >>= 7;
+    }
+    dst[pos++] = (uint8_t)h;
+    return true;
+}
+
+static inline bool _put_literal(const uint8_t *rgba, size_t from, size_t to, uint8_t *dst, size_t capacity, size_t &pos) {
+    if (to == from) return true;
+    const size_t bytes = (to - from) * 4;
+    if (!_put_header(dst, capacity, pos, (uint64_t)(to - from - 1) << 1) || pos + bytes > capacity) return false;
+    memcpy(dst + pos, rgba + from * 4, bytes);
+    pos += bytes;
+    return true;
+}
+
+size_t LottieFrameCodec::max_encoded_size(size_t pixels) {
+    // Worst case is a single literal token.
+    return pixels == 0 ? 0 : _header_size((uint64_t)(pixels - 1) << 1) + pixels * 4;
+}
+
+size_t LottieFrameCodec::encode(const uint8_t *rgba, size_t pixels, uint8_t *dst, size_t capacity) {
+    size_t pos = 0;
+    size_t literal = 0; // first pixel not yet emitted
+    size_t i = 0;
+    while (i < pixels) {
+        const uint32_t px = _load(rgba + i * 4);
+        size_t j = i + 1;
+        while (j < pixels && _load(rgba + j * 4) == px) j++;
+        if (j - i >= MIN_RUN) {
+            if (!_put_literal(rgba, literal, i, dst, capacity, pos)) return 0;
+            if (!_put_header(dst, capacity, pos, ((uint64_t)(j - i - 1) << 1) | 1) || pos + 4 > capacity) return 0;
+            memcpy(dst + pos, &px, 4);
+            pos += 4;
+            literal = j;
+        }
+        i = j;
+    }
+    if (!_put_literal(rgba, literal, pixels, dst, capacity, pos)) return 0;
+    return pos;
+}
+
+bool LottieFrameCodec::decode(const uint8_t *src, size_t size, uint8_t *dst, size_t pixels) {
+    const uint8_t *ip = src;
+    const uint8_t *const ip_end = src + size;
+    size_t op = 0;
+    while (ip < ip_end) {
+        uint64_t h = 0;
+        int shift = 0;
+        uint8_t b;
+        do {
+            if (ip >= ip_end || shift > 56) return false;
+            b = *ip++;
+            h |= (uint64_t)(b & 0x7F) << shift;
+            shift += 7;
+        } while (b & 0x80);
+
+        const uint64_t count = (h >> 1) + 1;
+        if (count > pixels - op) return false;
+        if (h & 1) {
+            if (ip_end - ip < 4) return false;
+            const uint32_t px = _load(ip);
+            ip += 4;
+            uint8_t *out = dst + op * 4;
+            if ((px & 0xFFu) == ((px >> 8) & 0xFFu) && (px & 0xFFFFu) == (px >> 16)) {
+                memset(out, (int)(px & 0xFFu), (size_t)count * 4); // e.g. transparent black
+            } else {
+                for (uint64_t k = 0; k < count; ++k) memcpy(out + k * 4, &px, 4);
+            }
+        } else {
+            const size_t bytes = (size_t)count * 4;
+            if ((size_t)(ip_end - ip) < bytes) return false;
+            memcpy(dst + op * 4, ip, bytes);
+            ip += bytes;
+        }
+        op += (size_t)count;
+    }
+    return op == pixels;
+}
@@ -0,0 +1,29 @@
+#ifndef LOTTIE_FRAME_CODEC_H
+#define LOTTIE_FRAME_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace godot {
+
+// Lossless run-length codec for RGBA8 frames, used by LottieFrameCache for its compressed
+// memory entries and disk records. Lottie frames are mostly flat colour over transparency, so
+// runs of identical pixels carry nearly all of the saving; everything else is stored verbatim.
+//
+// The stream is a sequence of tokens, each a LEB128 header h followed by its payload:
+// (h >> 1) + 1 pixels, either one repeated pixel (h & 1) or that many literal pixels.
+class LottieFrameCodec {
+public:
+    // Largest stream encode() can produce for `pixels` pixels.
+    static size_t max_encoded_size(size_t pixels);
+    // Encodes `pixels` RGBA8 pixels into `dst`. Returns the stream size, or 0 when it would not
+    // fit in `capacity` bytes, so a caller can give up early on frames that do not compress.
+    static size_t encode(const uint8_t *rgba, size_t pixels, uint8_t *dst, size_t capacity);
+    // Decodes a stream into exactly `pixels` RGBA8 pixels. Returns false, with `dst` partially
+    // written, when the stream is malformed or does not decode to that size.
+    static bool decode(const uint8_t *src, size_t size, uint8_t *dst, size_t pixels);
+};
+
+}
+
+#endif
@@ -0,0 +1,255 @@
+#include "lottie_manifest.h"
+#include "lottie_archive.h"
+#include <godot_cpp/classes/json.hpp>
+#include <godot_cpp/variant/array.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <algorithm>
+#include <mutex>
+
+using namespace godot;
+
+namespace {
+
+struct CachedManifest {
+    LottieArchive::Stamp stamp; // identity of the bundle contents that were parsed
+    std::shared_ptr<const LottieManifest> manifest;
+};
+
+std::mutex g_manifests_mutex;
+std::unordered_map<std::string, CachedManifest> g_manifests;
+
+std::string _key(const String &s) {
+    return std::string(s.utf8().get_data());
+}
+
+void _push_unique(std::vector<String> &list, const String &value) {
+    if (std::find(list.begin(), list.end(), value) == list.end()) list.push_back(value);
+}
+
+// States may be an array of names or {name|id} objects, or a map keyed by state name.
+std::vector<String> _parse_states(const Variant &sv) {
+    std::vector<String> out;
+    if (sv.get_type() == Variant::ARRAY) {
+        Array st = sv;
+        for (int k = 0; k < st.size(); k++) {
+            if (st[k].get_type() == Variant::DICTIONARY) {
+                Dictionary sd = st[k];
+                if (sd.has("name")) out.push_back((String)sd["name"]);
+                else if (sd.has("id")) out.push_back((String)sd["id"]);
+            } else if (st[k].get_type() == Variant::STRING) {
+                out.push_back((String)st[k]);
+            }
+        }
+    } else if (sv.get_type() == Variant::DICTIONARY) {
+        Dictionary st = sv;
+        Array keys = st.keys();
+        for (int k = 0; k < keys.size(); k++) {
+            String key = (String)keys[k];
+            Variant v = st[key];
+            if (v.get_type() == Variant::DICTIONARY) {
+                Dictionary sd = v;
+                if (sd.has("name")) out.push_back((String)sd["name"]);
+                else out.push_back(key);
+            } else {
+                out.push_back(key);
+            }
+        }
+    }
+    return out;
+}
+
+// A standalone state-machine JSON: {"states": [{"name": ..., "segment": <marker>}, ...]}.
+std::vector<String> _parse_states_json(const String &text, std::unordered_map<std::string, String> &r_segments) {
+    std::vector<String> out;
+    r_segments.clear();
+    Variant v = JSON::parse_string(text);
+    if (v.get_type() != Variant::DICTIONARY) return out;
+    Dictionary d = v;
+    if (d.has("states") && d["states"].get_type() == Variant::ARRAY) {
+        Array arr = d["states"];
+        for (int i = 0; i < arr.size(); i++) {
+            if (arr[i].get_type() != Variant::DICTIONARY) continue;
+            Dictionary sd = arr[i];
+            if (!sd.has("name")) continue;
+            String name = (String)sd["name"];
+            out.push_back(name);
+            if (sd.has("segment")) r_segments[_key(name)] = (String)sd["segment"];
+        }
+    }
+    return out;
+}
+
+// Heuristics: <machine>.json in a folder named like "states"/"machines", then any JSON there
+// containing the machine name, then the first JSON with "state" anywhere in its path.
+String _find_state_machine_file(const PackedStringArray &files, const String &machine_name) {
+    const String target_lc = (machine_name + String(".json")).to_lower();
+    for (int i = 0; i < files.size(); i++) {
+        String f = files[i];
+        if (f.ends_with("/")) continue;
+        String folder_lc = f.get_base_dir().to_lower();
+        if ((folder_lc.find("state") != -1 || folder_lc.find("machine") != -1) && f.get_file().to_lower() == target_lc) return f;
+    }
+    const String needle = machine_name.to_lower();
+    for (int i = 0; i < files.size(); i++) {
+        String f = files[i];
+        if (f.ends_with("/")) continue;
+        String folder_lc = f.get_base_dir().to_lower();
+        String fname_lc = f.get_file().to_lower();
+        if ((folder_lc.find("state") != -1 || folder_lc.find("machine") != -1) && fname_lc.ends_with(".json") && fname_lc.find(needle) != -1) return f;
+    }
+    for (int i = 0; i < files.size(); i++) {
+        String f = files[i];
+        if (f.ends_with("/")) continue;
+        String lf = f.to_lower();
+        if (lf.ends_with(".json") && lf.find("state") != -1) return f;
+    }
+    return String();
+}
+
+}
+
+std::shared_ptr<const LottieManifest> LottieManifest::load(const String &zip_path) {
+    const std::string key = _key(zip_path);
+    {
+        // A cache hit needs only the file's stamp, so the bundle is not even opened.
+        const LottieArchive::Stamp stamp = LottieArchive::stamp_of(zip_path);
+        std::lock_guard<std::mutex> lk(g_manifests_mutex);
+        auto it = g_manifests.find(key);
+        if (it != g_manifests.end() && it->second.stamp == stamp) return it->second.manifest;
+    }
+    std::shared_ptr<LottieArchive> archive = LottieArchive::open(zip_path);
+    if (!archive) return empty();
+    // Parsed outside the lock; two first loads of one bundle may both parse, and the last wins.
+    std::shared_ptr<LottieManifest> manifest = std::make_shared<LottieManifest>();
+    manifest->_parse(*archive);
+    std::lock_guard<std::mutex> lk(g_manifests_mutex);
+    CachedManifest &slot = g_manifests[key];
+    slot.stamp = archive->get_stamp();
+    slot.manifest = manifest;
+    return manifest;
+}
+
+const std::shared_ptr<const LottieManifest> &LottieManifest::empty() {
+    static const std::shared_ptr<const LottieManifest> none = std::make_shared<LottieManifest>();
+    return none;
+}
+
+void LottieManifest::clear_cache() {
+    std::lock_guard<std::mutex> lk(g_manifests_mutex);
+    g_manifests.clear();
+}
+
+String LottieManifest::get_inner_path(const String &id) const {
+    auto it = _inner_paths.find(_key(id));
+    return it != _inner_paths.end() ? it->second : String();
+}
+
+const std::vector<String> &LottieManifest::get_states(const String &machine) const {
+    static const std::vector<String> none;
+    const StateMachine *sm = _find_machine(machine);
+    return sm ? sm->states : none;
+}
+
+String LottieManifest::get_state_segment(const String &machine, const String &state) const {
+    const StateMachine *sm = _find_machine(machine);
+    if (!sm) return String();
+    auto it = sm->segments.find(_key(state));
+    return it != sm->segments.end() ? it->second : String();
+}
+
+const LottieManifest::StateMachine *LottieManifest::_find_machine(const String &name) const {
+    for (const StateMachine &sm : _machines) {
+        if (sm.name == name) return &sm;
+    }
+    return nullptr;
+}
+
+void LottieManifest::_parse(LottieArchive &archive) {
+    const PackedStringArray &files = archive.get_files();
+    String manifest_path = "manifest.json";
+    bool manifest_present = false;
+    for (int i = 0; i < files.size(); i++) {
+        String f = files[i];
+        if (f.to_lower().ends_with("manifest.json")) { manifest_path = f; manifest_present = true; break; }
+        if (f == manifest_path) { manifest_present = true; }
+    }
+    if (!manifest_present) return;
+    Variant parsed = JSON::parse_string(archive.read_file(manifest_path).get_string_from_utf8());
+    if (parsed.get_type() != Variant::DICTIONARY) return;
+    Dictionary manifest = parsed;
+
+    // animations: accept array or object map
+    auto add_animation = [&](const String &id, const Dictionary &a) {
+        _push_unique(_animation_ids, id);
+        String inner;
+        if (a.has("lottie")) inner = (String)a["lottie"]; // e.g. animations/<id>.json
+        else if (a.has("path")) inner = (String)a["path"]; // alias used by some tools
+        else inner = String("animations/") + id + ".json";
+        _inner_paths[_key(id)] = inner;
+    };
+    if (manifest.has("animations")) {
+        Variant anv = manifest["animations"];
+        if (anv.get_type() == Variant::ARRAY) {
+            Array arr = anv;
+            for (int i = 0; i < arr.size(); i++) {
+                if (arr[i].get_type() != Variant::DICTIONARY) continue;
+                Dictionary a = arr[i];
+                String id = a.has("id") ? (String)a["id"] : (a.has("name") ? (String)a["name"] : String());
+                if (!id.is_empty()) add_animation(id, a);
+            }
+        } else if (anv.get_type() == Variant::DICTIONARY) {
+            Dictionary amap = anv;
+            Array keys = amap.keys();
+            for (int i = 0; i < keys.size(); i++) {
+                String id = (String)keys[i];
+                add_animation(id, amap[id]);
+            }
+        }
+    }
+
+    // state machines: accept array or map; states can be array, map, or nodes list
+    auto add_machine = [&](const String &name, const Dictionary &sm) {
+        std::vector<String> states;
+        if (sm.has("states")) states = _parse_states(sm["states"]);
+        // Some tools store nodes instead of states
+        if (states.empty() && sm.has("nodes")) states = _parse_states(sm["nodes"]);
+        for (StateMachine &existing : _machines) {
+            if (existing.name == name) { existing.states = states; return; }
+        }
+        StateMachine entry;
+        entry.name = name;
+        entry.states = states;
+        _machines.push_back(entry);
+    };
+    if (manifest.has("stateMachines")) {
+        Variant smv = manifest["stateMachines"];
+        if (smv.get_type() == Variant::ARRAY) {
+            Array sms = smv;
+            for (int i = 0; i < sms.size(); i++) {
+                if (sms[i].get_type() != Variant::DICTIONARY) continue;
+                Dictionary sm = sms[i];
+                String name = sm.has("name") ? (String)sm["name"] : (sm.has("id") ? (String)sm["id"] : String("state_machine"));
+                add_machine(name, sm);
+            }
+        } else if (smv.get_type() == Variant::DICTIONARY) {
+            Dictionary smap = smv;
+            Array mkeys = smap.keys();
+            for (int i = 0; i < mkeys.size(); i++) {
+                String name = (String)mkeys[i];
+                add_machine(name, smap[name]);
+            }
+        }
+    }
+
+    // Supplement: machines without states in the manifest get them from their own JSON.
+    for (StateMachine &sm : _machines) {
+        if (!sm.states.empty()) continue;
+        String candidate = _find_state_machine_file(files, sm.name);
+        if (candidate.is_empty()) continue;
+        std::unordered_map<std::string, String> segments;
+        std::vector<String> states = _parse_states_json(archive.read_file(candidate).get_string_from_utf8(), segments);
+        if (states.empty()) continue;
+        sm.states = states;
+        sm.segments = segments;
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef LOTTIE_MANIFEST_H
+#define LOTTIE_MANIFEST_H
+
+#include <godot_cpp/variant/string.hpp>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace godot {
+
+// Parsed manifest of a .lottie bundle: animation ids with their inner JSON paths, and state
+// machines with their states and per-state marker segments. Manifests are parsed once per
+// bundle and shared read-only by every node using it; a bundle is parsed again only when its
+// size or mtime (LottieArchive::Stamp) changed. Safe to use from any thread.
+class LottieArchive;
+
+class LottieManifest {
+public:
+    struct StateMachine {
+        String name;
+        std::vector<String> states;
+        std::unordered_map<std::string, String> segments; // state -> marker name
+    };
+
+    // Shared manifest of `zip_path`. Never null: a bundle that cannot be opened, or has no
+    // readable manifest.json, yields an empty manifest.
+    static std::shared_ptr<const LottieManifest> load(const String &zip_path);
+    static const std::shared_ptr<const LottieManifest> &empty();
+    // Drops every cached manifest (module shutdown).
+    static void clear_cache();
+
+    const std::vector<String> &get_animation_ids() const { return _animation_ids; }
+    const std::vector<StateMachine> &get_state_machines() const { return _machines; }
+    // Inner JSON path of animation `id`, or an empty string for unknown ids.
+    String get_inner_path(const String &id) const;
+    // States of `machine`; empty for unknown machines.
+    const std::vector<String> &get_states(const String &machine) const;
+    // Marker segment mapped to `state` of `machine`, or an empty string.
+    String get_state_segment(const String &machine, const String &state) const;
+
+private:
+    std::vector<String> _animation_ids;
+    std::unordered_map<std::string, String> _inner_paths;
+    std::vector<StateMachine> _machines;
+
+    const StateMachine *_find_machine(const String &name) const;
+    void _parse(LottieArchive &archive);
+};
+
+}
+
+#endif
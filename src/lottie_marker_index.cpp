@@ -0,0 +1,229 @@
+#include "lottie_marker_index.h"
+#include <cstdlib>
+#include <mutex>
+
+using namespace godot;
+
+namespace {
+
+struct CachedIndex {
+    uint64_t stamp = 0;
+    std::shared_ptr<const LottieMarkerIndex> index;
+};
+
+std::mutex g_index_mutex;
+std::unordered_map<std::string, CachedIndex> g_indices;
+
+// Minimal pull scanner over JSON text: enough to walk the top-level object and the markers
+// array and to step over everything else without materializing it.
+struct JsonScanner {
+    const char *p;
+    const char *end;
+
+    void ws() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) ++p;
+    }
+    bool eat(char c) {
+        ws();
+        if (p < end && *p == c) { ++p; return true; }
+        return false;
+    }
+    bool peek(char c) {
+        ws();
+        return p < end && *p == c;
+    }
+
+    static void append_utf8(std::string &out, uint32_t cp) {
+        if (cp < 0x80) {
+            out += (char)cp;
+        } else if (cp < 0x800) {
+            out += (char)(0xC0 | (cp >> 6));
+            out += (char)(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += (char)(0xE0 | (cp >> 12));
+            out += (char)(0x80 | ((cp >> 6) & 0x3F));
+            out += (char)(0x80 | (cp & 0x3F));
+        } else {
+            out += (char)(0xF0 | (cp >> 18));
+            out += (char)(0x80 | ((cp >> 12) & 0x3F));
+            out += (char)(0x80 | ((cp >> 6) & 0x3F));
+            out += (char)(0x80 | (cp & 0x3F));
+        }
+    }
+
+    uint32_t hex4() {
+        if (end - p < 4) { p = end; return 0; }
+        char buf[5] = { p[0], p[1], p[2], p[3], 0 };
+        p += 4;
+        return (uint32_t)strtoul(buf, nullptr, 16);
+    }
+
+    // Reads a string token; with `out` null the contents are only skipped.
+    bool string(std::string *out) {
+        if (!eat('"')) return false;
+        while (p < end && *p != '"') {
+            if (*p != '\\') {
+                if (out) *out += *p;
+                ++p;
+                continue;
+            }
+            if (++p >= end) return false;
+            const char e = *p++;
+            if (!out) {
+                if (e == 'u') p = std::min(end, p + 4);
+                continue;
+            }
+            switch (e) {
+                case 'b': *out += '\b'; break;
+                case 'f': *out += '\f'; break;
+                case 'n': *out += '\n'; break;
+                case 'r': *out += '\r'; break;
+                case 't': *out += '\t'; break;
+                case 'u': {
+                    uint32_t cp = hex4();
+                    if (cp >= 0xD800 && cp < 0xDC00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+                        p += 2;
+                        const uint32_t lo = hex4();
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                    }
+                    append_utf8(*out, cp);
+                    break;
+                }
+                default: *out += e; break; // \" \\ \/
+            }
+        }
+        if (p >= end) return false;
+        ++p;
+        return true;
+    }
+
+    // The buffer is not NUL-terminated, so the token is copied (bounded by `end`) before strtod.
+    bool number(double &r_value) {
+        ws();
+        if (p >= end) return false;
+        char buf[64];
+        size_t n = 0;
+        while (p + n < end && n < sizeof(buf) - 1) {
+            const char c = p[n];
+            if ((c < '0' || c > '9') && c != '-' && c != '+' && c != '.' && c != 'e' && c != 'E') break;
+            buf[n++] = c;
+        }
+        buf[n] = 0;
+        char *num_end = nullptr;
+        r_value = strtod(buf, &num_end);
+        if (num_end == buf) return false;
+        p += num_end - buf;
+        return true;
+    }
+
+    // Skips any value; containers are stepped over by bracket depth, honouring strings.
+    bool skip() {
+        ws();
+        if (p >= end) return false;
+        if (*p == '"') return string(nullptr);
+        if (*p != '{' && *p != '[') {
+            while (p < end && *p != ',' && *p != '}' && *p != ']') ++p;
+            return true;
+        }
+        int depth = 0;
+        while (p < end) {
+            const char c = *p;
+            if (c == '"') {
+                if (!string(nullptr)) return false;
+                continue;
+            }
+            ++p;
+            if (c == '{' || c == '[') {
+                ++depth;
+            } else if (c == '}' || c == ']') {
+                if (--depth == 0) return true;
+            }
+        }
+        return false;
+    }
+};
+
+}
+
+std::shared_ptr<const LottieMarkerIndex> LottieMarkerIndex::find(const String &key, uint64_t stamp) {
+    std::lock_guard<std::mutex> lk(g_index_mutex);
+    auto it = g_indices.find(std::string(key.utf8().get_data()));
+    if (it == g_indices.end() || it->second.stamp != stamp) return nullptr;
+    return it->second.index;
+}
+
+std::shared_ptr<const LottieMarkerIndex> LottieMarkerIndex::build(const String &key, uint64_t stamp, const PackedByteArray &json) {
+    std::shared_ptr<LottieMarkerIndex> index = std::make_shared<LottieMarkerIndex>();
+    index->_scan(json.ptr(), (size_t)json.size());
+    std::lock_guard<std::mutex> lk(g_index_mutex);
+    CachedIndex &slot = g_indices[std::string(key.utf8().get_data())];
+    slot.stamp = stamp;
+    slot.index = index;
+    return index;
+}
+
+void LottieMarkerIndex::clear_cache() {
+    std::lock_guard<std::mutex> lk(g_index_mutex);
+    g_indices.clear();
+}
+
+bool LottieMarkerIndex::get_range(const String &name, float &r_begin, float &r_end) const {
+    auto it = _ranges.find(std::string(name.utf8().get_data()));
+    if (it == _ranges.end()) return false;
+    r_begin = it->second.first;
+    r_end = it->second.second;
+    return true;
+}
+
+void LottieMarkerIndex::_scan(const uint8_t *data, size_t size) {
+    if (!data || size == 0) return;
+    JsonScanner s{ reinterpret_cast<const char *>(data), reinterpret_cast<const char *>(data) + size };
+    if (!s.eat('{')) return;
+    while (!s.peek('}')) {
+        std::string key;
+        if (!s.string(&key) || !s.eat(':')) return;
+        if (key == "fr" || key == "ip" || key == "op") {
+            double v = 0.0;
+            if (!s.number(v)) return;
+            if (key == "fr") frame_rate = v;
+            else if (key == "ip") in_point = v;
+            else out_point = v;
+        } else if (key == "markers" && s.eat('[')) {
+            while (!s.peek(']')) {
+                if (!s.eat('{')) {
+                    if (!s.skip()) return;
+                } else {
+                    // "cm" is what Bodymovin writes; "n" is an alternative some tools use.
+                    std::string cm, n;
+                    bool has_cm = false;
+                    double tm = 0.0, dr = 0.0;
+                    while (!s.peek('}')) {
+                        std::string mkey;
+                        if (!s.string(&mkey) || !s.eat(':')) return;
+                        bool ok = true;
+                        if (mkey == "cm" && s.peek('"')) { ok = s.string(&cm); has_cm = true; }
+                        else if (mkey == "n" && s.peek('"')) ok = s.string(&n);
+                        else if (mkey == "tm") ok = s.number(tm);
+                        else if (mkey == "dr") ok = s.number(dr);
+                        else ok = s.skip();
+                        if (!ok) return;
+                        if (!s.eat(',')) break;
+                    }
+                    if (!s.eat('}')) return;
+                    const std::string &name = has_cm ? cm : n;
+                    if (!name.empty()) {
+                        float begin = (float)tm;
+                        float end_frame = (float)(tm + dr);
+                        if (end_frame <= begin) end_frame = begin + 1.0f;
+                        _ranges.emplace(name, std::make_pair(begin, end_frame)); // first marker of a name wins
+                    }
+                }
+                if (!s.eat(',')) break;
+            }
+            if (!s.eat(']')) return;
+        } else if (!s.skip()) {
+            return;
+        }
+        if (!s.eat(',')) break;
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef LOTTIE_MARKER_INDEX_H
+#define LOTTIE_MARKER_INDEX_H
+
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <godot_cpp/variant/string.hpp>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace godot {
+
+// Markers and timing of one Lottie JSON, taken with a single streaming scan of the top-level
+// object (layers and assets are skipped, never parsed) and shared process-wide by animation
+// key, so resolving a state's marker segment is a hash lookup.
+class LottieMarkerIndex {
+public:
+    // Cached index for `key`, or null when none was built for this stamp.
+    static std::shared_ptr<const LottieMarkerIndex> find(const String &key, uint64_t stamp);
+    // Scans `json` and caches the result under `key`; replaces an index with another stamp.
+    static std::shared_ptr<const LottieMarkerIndex> build(const String &key, uint64_t stamp, const PackedByteArray &json);
+    static void clear_cache();
+
+    double frame_rate = 60.0; // "fr"
+    double in_point = 0.0; // "ip"
+    double out_point = 0.0; // "op"
+
+    // Frame range of marker `name` (start "tm", length "dr" in frames; at least one frame).
+    bool get_range(const String &name, float &r_begin, float &r_end) const;
+    size_t get_marker_count() const { return _ranges.size(); }
+
+private:
+    std::unordered_map<std::string, std::pair<float, float>> _ranges;
+
+    void _scan(const uint8_t *data, size_t size);
+};
+
+}
+
+#endif
@@ -0,0 +1,491 @@
+#include "lottie_pixel_ops.h"
+#include <algorithm>
+#include <cstring>
+
+// x86 kernels are compiled per ISA level with target attributes and picked at runtime,
+// so a binary built for the x86_64 baseline still uses SSSE3/AVX2/AVX-512 where available.
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define LOTTIE_X86 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define LOTTIE_TARGET(isa)
+    #else
+        #define LOTTIE_TARGET(isa) __attribute__((target(isa)))
+    #endif
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define LOTTIE_SIMD_SSE2 1
+#endif
+#if defined(__ARM_NEON)
+    #include <arm_neon.h>
+    #define LOTTIE_SIMD_NEON 1
+#endif
+
+using namespace godot;
+
+static inline void _argb_to_rgba_scalar(const uint32_t *src, uint8_t *dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t p = src[i];
+        dst[i*4 + 0] = (uint8_t)((p >> 16) & 0xFF);
+        dst[i*4 + 1] = (uint8_t)((p >> 8) & 0xFF);
+        dst[i*4 + 2] = (uint8_t)(p & 0xFF);
+        dst[i*4 + 3] = (uint8_t)((p >> 24) & 0xFF);
+    }
+}
+
+static inline void _unpremultiply_scalar(uint8_t *p, size_t count) {
+    for (size_t i = 0; i < count; ++i, p += 4) {
+        uint8_t a = p[3];
+        if (a == 0) {
+            p[0] = p[1] = p[2] = 0;
+            continue;
+        }
+        if (a == 255) continue;
+        p[0] = (uint8_t)std::min(255, (int)((int)p[0] * 255 + (a / 2)) / (int)a);
+        p[1] = (uint8_t)std::min(255, (int)((int)p[1] * 255 + (a / 2)) / (int)a);
+        p[2] = (uint8_t)std::min(255, (int)((int)p[2] * 255 + (a / 2)) / (int)a);
+    }
+}
+
+// The vector unpremultiply paths compute (c * 255 + a / 2) / a in float. The numerator is an
+// integer below 2^16, so the correctly rounded quotient truncates to the same value as the
+// integer division and results match _unpremultiply_scalar bit for bit; SSE2 multiplies by a
+// refined reciprocal instead (see there). a == 255 needs no special case (the formula returns
+// c); a == 0 lanes are masked to transparent black. Groups holding only opaque and transparent
+// pixels, most of a typical frame, skip the arithmetic.
+
+#if LOTTIE_X86
+LOTTIE_TARGET("sse2")
+static void _argb_to_rgba_sse2(const uint32_t *src, uint8_t *dst, size_t count) {
+    // No byte shuffle before SSSE3: keep A/G in place and swap R/B with shifts.
+    const __m128i ag = _mm_set1_epi32((int)0xFF00FF00);
+    const __m128i low = _mm_set1_epi32(0xFF);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m128i r = _mm_and_si128(_mm_srli_epi32(p, 16), low);
+        __m128i b = _mm_slli_epi32(_mm_and_si128(p, low), 16);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), _mm_or_si128(_mm_and_si128(p, ag), _mm_or_si128(r, b)));
+    }
+    _argb_to_rgba_scalar(src + i, dst + i * 4, count - i);
+}
+
+LOTTIE_TARGET("ssse3")
+static void _argb_to_rgba_ssse3(const uint32_t *src, uint8_t *dst, size_t count) {
+    const __m128i mask = _mm_setr_epi8(
+        2, 1, 0, 3,
+        6, 5, 4, 7,
+        10, 9, 8, 11,
+        14, 13, 12, 15
+    );
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), _mm_shuffle_epi8(pixels, mask));
+    }
+    _argb_to_rgba_scalar(src + i, dst + i * 4, count - i);
+}
+
+LOTTIE_TARGET("avx2")
+static void _argb_to_rgba_avx2(const uint32_t *src, uint8_t *dst, size_t count) {
+    const __m256i mask = _mm256_setr_epi8(
+        2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+        2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15
+    );
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i * 4), _mm256_shuffle_epi8(pixels, mask));
+    }
+    _argb_to_rgba_scalar(src + i, dst + i * 4, count - i);
+}
+
+// GCC 12's own avx512fintrin.h trips -W(maybe-)uninitialized on its _mm512_undefined_*()
+// placeholders; known false positives, silenced for the AVX-512 kernels only.
+#if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wuninitialized"
+    #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+LOTTIE_TARGET("avx512f,avx512bw")
+static void _argb_to_rgba_avx512(const uint32_t *src, uint8_t *dst, size_t count) {
+    const __m512i mask = _mm512_broadcast_i32x4(_mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15));
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512i pixels = _mm512_loadu_si512(src + i);
+        _mm512_storeu_si512(dst + i * 4, _mm512_shuffle_epi8(pixels, mask));
+    }
+    _argb_to_rgba_scalar(src + i, dst + i * 4, count - i);
+}
+
+LOTTIE_TARGET("sse2")
+static void _unpremultiply_sse2(uint8_t *p, size_t count) {
+    const __m128i byte_mask = _mm_set1_epi32(0xFF);
+    const __m128 c255 = _mm_set1_ps(255.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128i opaque = _mm_set1_epi32((int)0xFF000000);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4, p += 16) {
+        __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        __m128i a_bits = _mm_and_si128(px, opaque);
+        __m128i clear = _mm_cmpeq_epi32(a_bits, _mm_setzero_si128());
+        if (_mm_movemask_epi8(_mm_or_si128(clear, _mm_cmpeq_epi32(a_bits, opaque))) == 0xFFFF) {
+            // Only opaque and transparent pixels: nothing to divide.
+            if (_mm_movemask_epi8(clear)) _mm_storeu_si128(reinterpret_cast<__m128i *>(p), _mm_andnot_si128(clear, px));
+            continue;
+        }
+        __m128i a = _mm_srli_epi32(px, 24);
+        __m128 af = _mm_cvtepi32_ps(a);
+        // One reciprocal per pixel instead of a division per channel. rcpps refined by a Newton
+        // step is within 2^-21 of 1/a, so n * r misses n / a <= 255 by under 1.2e-4. Adding 0.5
+        // to the numerator keeps the exact (n + 0.5) / a at least 0.5 / a (> 1.9e-3) away from
+        // an integer, so truncation still gives the integer quotient.
+        __m128 bias = _mm_add_ps(_mm_cvtepi32_ps(_mm_srli_epi32(a, 1)), half);
+        __m128 r = _mm_rcp_ps(_mm_max_ps(af, one));
+        r = _mm_mul_ps(r, _mm_sub_ps(two, _mm_mul_ps(af, r)));
+        __m128i out = a_bits;
+        for (int ch = 0; ch < 3; ++ch) {
+            __m128i c = _mm_and_si128(_mm_srli_epi32(px, ch * 8), byte_mask);
+            __m128 n = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(c), c255), bias);
+            __m128i q = _mm_cvttps_epi32(_mm_min_ps(_mm_mul_ps(n, r), c255));
+            out = _mm_or_si128(out, _mm_slli_epi32(q, ch * 8));
+        }
+        out = _mm_andnot_si128(clear, out);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(p), out);
+    }
+    _unpremultiply_scalar(p, count - i);
+}
+
+LOTTIE_TARGET("avx2")
+static void _unpremultiply_avx2(uint8_t *p, size_t count) {
+    const __m256i byte_mask = _mm256_set1_epi32(0xFF);
+    const __m256 c255 = _mm256_set1_ps(255.0f);
+    const __m256i opaque = _mm256_set1_epi32((int)0xFF000000);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8, p += 32) {
+        __m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        __m256i a_bits = _mm256_and_si256(px, opaque);
+        __m256i clear = _mm256_cmpeq_epi32(a_bits, _mm256_setzero_si256());
+        if (_mm256_movemask_epi8(_mm256_or_si256(clear, _mm256_cmpeq_epi32(a_bits, opaque))) == -1) {
+            if (_mm256_movemask_epi8(clear)) _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), _mm256_andnot_si256(clear, px));
+            continue;
+        }
+        __m256i a = _mm256_srli_epi32(px, 24);
+        __m256 af = _mm256_cvtepi32_ps(a);
+        __m256 bias = _mm256_cvtepi32_ps(_mm256_srli_epi32(a, 1));
+        __m256i out = a_bits;
+        for (int ch = 0; ch < 3; ++ch) {
+            __m256i c = _mm256_and_si256(_mm256_srli_epi32(px, ch * 8), byte_mask);
+            __m256 n = _mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(c), c255), bias);
+            __m256i q = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_div_ps(n, af), c255));
+            out = _mm256_or_si256(out, _mm256_slli_epi32(q, ch * 8));
+        }
+        out = _mm256_andnot_si256(clear, out);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), out);
+    }
+    _unpremultiply_scalar(p, count - i);
+}
+
+LOTTIE_TARGET("avx512f,avx512bw")
+static void _unpremultiply_avx512(uint8_t *p, size_t count) {
+    const __m512i byte_mask = _mm512_set1_epi32(0xFF);
+    const __m512 c255 = _mm512_set1_ps(255.0f);
+    const __m512i opaque = _mm512_set1_epi32((int)0xFF000000);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16, p += 64) {
+        __m512i px = _mm512_loadu_si512(p);
+        __m512i a_bits = _mm512_and_si512(px, opaque);
+        const __mmask16 visible = _mm512_test_epi32_mask(a_bits, a_bits);
+        if ((__mmask16)(_mm512_cmpeq_epi32_mask(a_bits, opaque) | (__mmask16)~visible) == 0xFFFF) {
+            if (visible != 0xFFFF) _mm512_storeu_si512(p, _mm512_maskz_mov_epi32(visible, px));
+            continue;
+        }
+        __m512i a = _mm512_srli_epi32(px, 24);
+        __m512 af = _mm512_cvtepi32_ps(a);
+        __m512 bias = _mm512_cvtepi32_ps(_mm512_srli_epi32(a, 1));
+        __m512i out = a_bits;
+        for (int ch = 0; ch < 3; ++ch) {
+            __m512i c = _mm512_and_si512(_mm512_srli_epi32(px, (unsigned)ch * 8), byte_mask);
+            __m512 n = _mm512_add_ps(_mm512_mul_ps(_mm512_cvtepi32_ps(c), c255), bias);
+            __m512i q = _mm512_cvttps_epi32(_mm512_min_ps(_mm512_div_ps(n, af), c255));
+            out = _mm512_or_si512(out, _mm512_slli_epi32(q, (unsigned)ch * 8));
+        }
+        out = _mm512_maskz_mov_epi32(visible, out);
+        _mm512_storeu_si512(p, out);
+    }
+    _unpremultiply_scalar(p, count - i);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC diagnostic pop
+#endif
+
+static int _detect_x86_isa() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int r[4];
+    __cpuid(r, 0);
+    const int max_leaf = r[0];
+    __cpuid(r, 1);
+    const bool sse2 = (r[3] & (1 << 26)) != 0;
+    const bool ssse3 = (r[2] & (1 << 9)) != 0;
+    const bool osxsave_avx = (r[2] & (1 << 27)) && (r[2] & (1 << 28));
+    bool avx2 = false;
+    bool avx512 = false;
+    if (max_leaf >= 7 && osxsave_avx) {
+        // The OS must save YMM (and opmask/ZMM) state for the wider paths to be usable.
+        const unsigned long long xcr0 = _xgetbv(0);
+        __cpuidex(r, 7, 0);
+        avx2 = (xcr0 & 0x6) == 0x6 && (r[1] & (1 << 5));
+        avx512 = (xcr0 & 0xE6) == 0xE6 && (r[1] & (1 << 16)) && (r[1] & (1 << 30));
+    }
+#else
+    __builtin_cpu_init();
+    const bool sse2 = __builtin_cpu_supports("sse2");
+    const bool ssse3 = __builtin_cpu_supports("ssse3");
+    const bool avx2 = __builtin_cpu_supports("avx2");
+    const bool avx512 = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#endif
+    if (avx512) return LottiePixelOps::ISA_AVX512;
+    if (avx2) return LottiePixelOps::ISA_AVX2;
+    if (ssse3) return LottiePixelOps::ISA_SSSE3;
+    if (sse2) return LottiePixelOps::ISA_SSE2;
+    return LottiePixelOps::ISA_SCALAR;
+}
+#endif
+
+#if LOTTIE_SIMD_NEON
+static void _argb_to_rgba_neon(const uint32_t *src, uint8_t *dst, size_t count) {
+    size_t vec_count = count / 4;
+    static const uint8_t tbl_data[16] = {
+        2,1,0,3, 6,5,4,7, 10,9,8,11, 14,13,12,15
+    };
+    uint8x16_t tbl = vld1q_u8(tbl_data);
+    for (size_t i = 0; i < vec_count; ++i) {
+        uint8x16_t pixels = vld1q_u8(reinterpret_cast<const uint8_t*>(&src[i*4]));
+#if defined(__aarch64__) || defined(__ARM_FEATURE_QBIT)
+        uint8x16_t shuffled = vqtbl1q_u8(pixels, tbl);
+#else
+        uint8_t tmp[16];
+        vst1q_u8(tmp, pixels);
+        uint8_t out[16];
+        for (int k=0;k<16;k++) out[k] = tmp[tbl_data[k]];
+        pixels = vld1q_u8(out);
+        uint8x16_t shuffled = pixels;
+#endif
+        vst1q_u8(&dst[i*16], shuffled);
+    }
+    size_t processed = vec_count * 4;
+    _argb_to_rgba_scalar(src + processed, dst + processed * 4, count - processed);
+}
+#endif
+
+#if LOTTIE_SIMD_NEON && defined(__aarch64__)
+static void _unpremultiply_neon(uint8_t *p, size_t count) {
+    const uint32x4_t byte_mask = vdupq_n_u32(0xFF);
+    const float32x4_t c255 = vdupq_n_f32(255.0f);
+    const uint32x4_t opaque = vdupq_n_u32(0xFF000000u);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4, p += 16) {
+        uint32x4_t px = vreinterpretq_u32_u8(vld1q_u8(p));
+        uint32x4_t a_bits = vandq_u32(px, opaque);
+        if (vminvq_u32(vceqq_u32(a_bits, opaque)) != 0) continue;
+        uint32x4_t a = vshrq_n_u32(px, 24);
+        float32x4_t af = vcvtq_f32_u32(a);
+        float32x4_t bias = vcvtq_f32_u32(vshrq_n_u32(a, 1));
+        uint32x4_t r = vandq_u32(px, byte_mask);
+        uint32x4_t g = vandq_u32(vshrq_n_u32(px, 8), byte_mask);
+        uint32x4_t b = vandq_u32(vshrq_n_u32(px, 16), byte_mask);
+        r = vcvtq_u32_f32(vminq_f32(vdivq_f32(vmlaq_f32(bias, vcvtq_f32_u32(r), c255), af), c255));
+        g = vcvtq_u32_f32(vminq_f32(vdivq_f32(vmlaq_f32(bias, vcvtq_f32_u32(g), c255), af), c255));
+        b = vcvtq_u32_f32(vminq_f32(vdivq_f32(vmlaq_f32(bias, vcvtq_f32_u32(b), c255), af), c255));
+        uint32x4_t out = vorrq_u32(vorrq_u32(a_bits, r), vorrq_u32(vshlq_n_u32(g, 8), vshlq_n_u32(b, 16)));
+        out = vbicq_u32(out, vceqq_u32(a, vdupq_n_u32(0)));
+        vst1q_u8(p, vreinterpretq_u8_u32(out));
+    }
+    _unpremultiply_scalar(p, count - i);
+}
+#endif
+
+struct _PixelKernels {
+    void (*argb_to_rgba)(const uint32_t *, uint8_t *, size_t);
+    void (*unpremultiply)(uint8_t *, size_t);
+    const char *isa;
+};
+
+// Best level this CPU supports; every lower level of the same family runs too.
+static int _detect_isa() {
+#if LOTTIE_X86
+    return _detect_x86_isa();
+#elif LOTTIE_SIMD_NEON
+    return LottiePixelOps::ISA_NEON;
+#else
+    return LottiePixelOps::ISA_SCALAR;
+#endif
+}
+
+// Kernels for `isa`, or false when this build has none for it.
+static bool _kernels_for(int isa, _PixelKernels &r_kernels) {
+    switch (isa) {
+        case LottiePixelOps::ISA_SCALAR: r_kernels = { _argb_to_rgba_scalar, _unpremultiply_scalar, "scalar" }; return true;
+#if LOTTIE_X86
+        case LottiePixelOps::ISA_AVX512: r_kernels = { _argb_to_rgba_avx512, _unpremultiply_avx512, "AVX-512BW" }; return true;
+        case LottiePixelOps::ISA_AVX2: r_kernels = { _argb_to_rgba_avx2, _unpremultiply_avx2, "AVX2" }; return true;
+        case LottiePixelOps::ISA_SSSE3: r_kernels = { _argb_to_rgba_ssse3, _unpremultiply_sse2, "SSSE3" }; return true;
+        case LottiePixelOps::ISA_SSE2: r_kernels = { _argb_to_rgba_sse2, _unpremultiply_sse2, "SSE2" }; return true;
+#elif LOTTIE_SIMD_NEON && defined(__aarch64__)
+        case LottiePixelOps::ISA_NEON: r_kernels = { _argb_to_rgba_neon, _unpremultiply_neon, "NEON" }; return true;
+#elif LOTTIE_SIMD_NEON
+        case LottiePixelOps::ISA_NEON: r_kernels = { _argb_to_rgba_neon, _unpremultiply_scalar, "NEON" }; return true;
+#endif
+        default: return false;
+    }
+}
+
+static _PixelKernels _select_kernels() {
+    _PixelKernels k;
+    if (!_kernels_for(_detect_isa(), k)) _kernels_for(LottiePixelOps::ISA_SCALAR, k);
+    return k;
+}
+
+static _PixelKernels &_kernels() {
+    static _PixelKernels kernels = _select_kernels();
+    return kernels;
+}
+
+const char *LottiePixelOps::get_isa_name() {
+    return _kernels().isa;
+}
+
+bool LottiePixelOps::force_isa(Isa isa) {
+    _PixelKernels k;
+    if ((int)isa > _detect_isa() || !_kernels_for(isa, k)) return false;
+    _kernels() = k;
+    return true;
+}
+
+void LottiePixelOps::argb_to_rgba(const uint32_t *src, uint8_t *dst, size_t count) {
+    _kernels().argb_to_rgba(src, dst, count);
+}
+
+void LottiePixelOps::unpremultiply(uint8_t *rgba, size_t count) {
+    if (!rgba) return;
+    _kernels().unpremultiply(rgba, count);
+}
+
+// Fills one transparent pixel from its first visible neighbour (row-major 3x3 order).
+static inline void _bleed_pixel(uint8_t *rgba, int w, int x, int y) {
+    uint8_t *px = rgba + ((size_t)y * (size_t)w + (size_t)x) * 4;
+    for (int dy = -1; dy <= 1; ++dy) {
+        const uint8_t *row = rgba + ((size_t)(y + dy) * (size_t)w) * 4;
+        for (int dx = -1; dx <= 1; ++dx) {
+            if (dx == 0 && dy == 0) continue;
+            const uint8_t *n = row + (size_t)(x + dx) * 4;
+            if (n[3] > 0) {
+                px[0] = n[0];
+                px[1] = n[1];
+                px[2] = n[2];
+                return;
+            }
+        }
+    }
+}
+
+void LottiePixelOps::fix_alpha_border(uint8_t *rgba, int w, int h, int x0, int y0, int x1, int y1) {
+    if (!rgba || w <= 2 || h <= 2) return;
+    x0 = std::max(1, x0);
+    y0 = std::max(1, y0);
+    x1 = std::min(w - 1, x1);
+    y1 = std::min(h - 1, y1);
+    const size_t stride = (size_t)w;
+    const uint32_t *px32 = reinterpret_cast<const uint32_t *>(rgba);
+    for (int y = y0; y < y1; ++y) {
+        int x = x0;
+#if LOTTIE_SIMD_SSE2
+        // Four pixels at a time: skip groups that are fully visible, or transparent with no
+        // visible pixel anywhere in their 3x3 neighbourhoods (the bulk of most frames).
+        const __m128i alpha_mask = _mm_set1_epi32((int)0xFF000000);
+        const __m128i zero = _mm_setzero_si128();
+        for (; x + 4 <= x1; x += 4) {
+            const uint32_t *c = px32 + (size_t)y * stride + (size_t)x;
+            __m128i center = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(c)), alpha_mask);
+            int transparent = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(center, zero)));
+            if (transparent == 0) continue;
+            __m128i any = center;
+            for (int dy = -1; dy <= 1; ++dy) {
+                const uint32_t *r = c + (ptrdiff_t)dy * (ptrdiff_t)stride;
+                any = _mm_or_si128(any, _mm_loadu_si128(reinterpret_cast<const __m128i *>(r - 1)));
+                any = _mm_or_si128(any, _mm_loadu_si128(reinterpret_cast<const __m128i *>(r)));
+                any = _mm_or_si128(any, _mm_loadu_si128(reinterpret_cast<const __m128i *>(r + 1)));
+            }
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(any, alpha_mask), zero)) == 0xFFFF) continue;
+            for (int k = 0; k < 4; ++k) {
+                if (transparent & (1 << k)) _bleed_pixel(rgba, w, x + k, y);
+            }
+        }
+#elif LOTTIE_SIMD_NEON && defined(__aarch64__)
+        const uint32x4_t alpha_mask = vdupq_n_u32(0xFF000000u);
+        for (; x + 4 <= x1; x += 4) {
+            const uint32_t *c = px32 + (size_t)y * stride + (size_t)x;
+            uint32x4_t center = vandq_u32(vld1q_u32(c), alpha_mask);
+            uint32x4_t transparent_lanes = vceqq_u32(center, vdupq_n_u32(0));
+            if (vmaxvq_u32(transparent_lanes) == 0) continue;
+            uint32x4_t any = center;
+            for (int dy = -1; dy <= 1; ++dy) {
+                const uint32_t *r = c + (ptrdiff_t)dy * (ptrdiff_t)stride;
+                any = vorrq_u32(any, vld1q_u32(r - 1));
+                any = vorrq_u32(any, vld1q_u32(r));
+                any = vorrq_u32(any, vld1q_u32(r + 1));
+            }
+            if (vmaxvq_u32(vandq_u32(any, alpha_mask)) == 0) continue;
+            uint32_t lanes[4];
+            vst1q_u32(lanes, transparent_lanes);
+            for (int k = 0; k < 4; ++k) {
+                if (lanes[k]) _bleed_pixel(rgba, w, x + k, y);
+            }
+        }
+#endif
+        for (; x < x1; ++x) {
+            if (rgba[((size_t)y * stride + (size_t)x) * 4 + 3] == 0) _bleed_pixel(rgba, w, x, y);
+        }
+    }
+}
+
+// Row y can only be border-fixed once row y + 1 is converted, so the fix trails one row behind.
+template <bool Unpremultiply, bool FixBorder>
+static void _post_process_rows(const uint32_t *src, uint8_t *dst, int w, int h, int x0, int y0, int x1, int y1) {
+    const size_t n = (size_t)(x1 - x0);
+    for (int y = y0; y < y1; ++y) {
+        const size_t offset = (size_t)y * (size_t)w + (size_t)x0;
+        LottiePixelOps::argb_to_rgba(src + offset, dst + offset * 4, n);
+        if (Unpremultiply) LottiePixelOps::unpremultiply(dst + offset * 4, n);
+        if (FixBorder && y > y0) LottiePixelOps::fix_alpha_border(dst, w, h, x0, y - 1, x1, y);
+    }
+    if (FixBorder && y1 > y0) LottiePixelOps::fix_alpha_border(dst, w, h, x0, y1 - 1, x1, y1);
+}
+
+void LottiePixelOps::post_process(const uint32_t *src, uint8_t *dst, int w, int h, int x0, int y0, int x1, int y1, bool unpremultiply, bool fix_border) {
+    if (!src || !dst) return;
+    x0 = std::max(0, x0);
+    y0 = std::max(0, y0);
+    x1 = std::min(w, x1);
+    y1 = std::min(h, y1);
+    if (x0 >= x1 || y0 >= y1) return;
+    if (unpremultiply) {
+        if (fix_border) _post_process_rows<true, true>(src, dst, w, h, x0, y0, x1, y1);
+        else _post_process_rows<true, false>(src, dst, w, h, x0, y0, x1, y1);
+    } else {
+        if (fix_border) _post_process_rows<false, true>(src, dst, w, h, x0, y0, x1, y1);
+        else _post_process_rows<false, false>(src, dst, w, h, x0, y0, x1, y1);
+    }
+}
+
+void LottiePixelOps::copy_rect(const uint32_t *src, uint8_t *dst, int w, int x0, int y0, int x1, int y1) {
+    if (!src || !dst || x1 <= x0) return;
+    const size_t bytes = (size_t)(x1 - x0) * 4;
+    for (int y = y0; y < y1; ++y) {
+        const size_t offset = (size_t)y * (size_t)w + (size_t)x0;
+        memcpy(dst + offset * 4, src + offset, bytes);
+    }
+}
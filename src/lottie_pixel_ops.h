@@ -0,0 +1,49 @@
+#ifndef LOTTIE_PIXEL_OPS_H
+#define LOTTIE_PIXEL_OPS_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace godot {
+
+// Pixel kernels applied to ThorVG output before it is handed to Godot. On x86 the swizzle and
+// unpremultiply kernels are selected once at startup from the CPU's feature flags.
+class LottiePixelOps {
+public:
+    enum Isa {
+        ISA_SCALAR,
+        ISA_SSE2,
+        ISA_SSSE3,
+        ISA_AVX2,
+        ISA_AVX512,
+        ISA_NEON,
+        ISA_MAX,
+    };
+
+    // Instruction set the kernels were dispatched to on this CPU, e.g. "AVX2".
+    static const char *get_isa_name();
+    // Pins dispatch to `isa` (tests and benchmarks only; not safe while kernels are running).
+    // Returns false, leaving dispatch unchanged, when this build or CPU cannot run that level.
+    static bool force_isa(Isa isa);
+
+    // ThorVG ARGB8888 words (0xAARRGGBB) to RGBA8 bytes.
+    static void argb_to_rgba(const uint32_t *src, uint8_t *dst, size_t count);
+    // Premultiplied to straight alpha; fully transparent pixels become transparent black.
+    static void unpremultiply(uint8_t *rgba, size_t count);
+    // Copies the colour of the first visible 3x3 neighbour into each fully transparent pixel of
+    // [x0,x1)x[y0,y1), so bilinear filtering does not pull in black at shape edges. Runs in place:
+    // only transparent pixels are written and only visible ones are read. The outermost image
+    // border is never written.
+    static void fix_alpha_border(uint8_t *rgba, int w, int h, int x0, int y0, int x1, int y1);
+
+    // All of the above in one pass over [x0,x1)x[y0,y1) of a w x h frame: each row is swizzled,
+    // optionally unpremultiplied, and the row above it border-fixed while both are still in cache.
+    static void post_process(const uint32_t *src, uint8_t *dst, int w, int h, int x0, int y0, int x1, int y1, bool unpremultiply, bool fix_border);
+    // Copies [x0,x1)x[y0,y1) of a frame that is already in upload layout (premultiplied ABGR8888
+    // words are RGBA8 bytes on little-endian), with no per-pixel work.
+    static void copy_rect(const uint32_t *src, uint8_t *dst, int w, int x0, int y0, int x1, int y1);
+};
+
+}
+
+#endif
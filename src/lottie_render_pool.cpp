@@ -0,0 +1,107 @@
+#include "lottie_render_pool.h"
+#include <godot_cpp/core/memory.hpp>
+#include <godot_cpp/classes/project_settings.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+#include <algorithm>
+
+using namespace godot;
+
+static LottieRenderPool *singleton = nullptr;
+
+int LottieRenderPool::default_thread_count() {
+    // Leave the remaining cores to ThorVG's own task scheduler and the engine.
+    int hw = (int)std::thread::hardware_concurrency();
+    if (hw <= 0) hw = 4;
+    return std::clamp(hw / 2, 1, 8);
+}
+
+int LottieRenderPool::configured_thread_count() {
+    int threads = 0;
+    ProjectSettings *ps = ProjectSettings::get_singleton();
+    if (ps && ps->has_setting("lottie/rendering/worker_threads")) {
+        threads = (int)ps->get_setting("lottie/rendering/worker_threads");
+    }
+    return threads > 0 ? threads : default_thread_count();
+}
+
+LottieRenderPool *LottieRenderPool::get_singleton() {
+    if (!singleton) {
+        singleton = memnew(LottieRenderPool(configured_thread_count()));
+    }
+    return singleton;
+}
+
+bool LottieRenderPool::has_singleton() {
+    return singleton != nullptr;
+}
+
+void LottieRenderPool::shutdown() {
+    if (!singleton) return;
+    memdelete(singleton);
+    singleton = nullptr;
+}
+
+LottieRenderPool::LottieRenderPool(int thread_count) {
+    thread_count = std::max(1, thread_count);
+    _running.assign((size_t)thread_count, nullptr);
+    _threads.reserve((size_t)thread_count);
+    for (int i = 0; i < thread_count; ++i) {
+        _threads.emplace_back([this, i]() { _thread_main(i); });
+    }
+    UtilityFunctions::print("Lottie render pool started with ", thread_count, " worker threads");
+}
+
+LottieRenderPool::~LottieRenderPool() {
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        _stop = true;
+        _queue.clear(); // pending work is dropped on shutdown
+    }
+    _work_cv.notify_all();
+    for (std::thread &t : _threads) {
+        if (t.joinable()) t.join();
+    }
+}
+
+void LottieRenderPool::submit(const void *owner, std::function<void()> task) {
+    if (!task) return;
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        if (_stop) return;
+        _queue.push_back(Task{owner, std::move(task)});
+    }
+    _work_cv.notify_one();
+}
+
+void LottieRenderPool::cancel(const void *owner) {
+    std::unique_lock<std::mutex> lk(_mutex);
+    _queue.erase(std::remove_if(_queue.begin(), _queue.end(), [owner](const Task &t) { return t.owner == owner; }), _queue.end());
+    _done_cv.wait(lk, [this, owner]() { return !_is_running_locked(owner); });
+}
+
+bool LottieRenderPool::_is_running_locked(const void *owner) const {
+    for (const void *o : _running) {
+        if (o == owner) return true;
+    }
+    return false;
+}
+
+void LottieRenderPool::_thread_main(int slot) {
+    while (true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lk(_mutex);
+            _work_cv.wait(lk, [this]() { return _stop || !_queue.empty(); });
+            if (_stop) return;
+            task = std::move(_queue.front());
+            _queue.pop_front();
+            _running[(size_t)slot] = task.owner;
+        }
+        task.fn();
+        {
+            std::lock_guard<std::mutex> lk(_mutex);
+            _running[(size_t)slot] = nullptr;
+        }
+        _done_cv.notify_all();
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef LOTTIE_RENDER_POOL_H
+#define LOTTIE_RENDER_POOL_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <vector>
+
+namespace godot {
+
+// Process-wide fixed-size worker pool servicing render jobs of all LottieAnimation nodes.
+// Tasks are tagged with an owner so a node can drop its queued work and wait for
+// in-flight work before freeing the state those tasks touch.
+class LottieRenderPool {
+public:
+    static LottieRenderPool *get_singleton();
+    static bool has_singleton();
+    static void shutdown();
+
+    explicit LottieRenderPool(int thread_count);
+    ~LottieRenderPool();
+
+    void submit(const void *owner, std::function<void()> task);
+    // Removes queued tasks of `owner` and blocks until none of its tasks is running.
+    // Must not be called from a pool thread running a task of the same owner.
+    void cancel(const void *owner);
+    int get_thread_count() const { return (int)_threads.size(); }
+
+    static int default_thread_count();
+    // Size the pool has or will have (lottie/rendering/worker_threads, else the default),
+    // without creating it.
+    static int configured_thread_count();
+
+private:
+    struct Task {
+        const void *owner = nullptr;
+        std::function<void()> fn;
+    };
+
+    std::vector<std::thread> _threads;
+    std::vector<const void *> _running; // owner currently executing on each thread slot
+    std::deque<Task> _queue;
+    std::mutex _mutex;
+    std::condition_variable _work_cv;
+    std::condition_variable _done_cv;
+    bool _stop = false;
+
+    void _thread_main(int slot);
+    bool _is_running_locked(const void *owner) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,76 @@
+#include "lottie_render_scheduler.h"
+#include "lottie_animation.h"
+#include "lottie_render_pool.h"
+#include <godot_cpp/core/memory.hpp>
+#include <godot_cpp/classes/project_settings.hpp>
+#include <godot_cpp/variant/callable_method_pointer.hpp>
+#include <algorithm>
+
+using namespace godot;
+
+static LottieRenderScheduler *singleton = nullptr;
+
+LottieRenderScheduler *LottieRenderScheduler::get_singleton() {
+    if (!singleton) {
+        singleton = memnew(LottieRenderScheduler);
+        ProjectSettings *ps = ProjectSettings::get_singleton();
+        if (ps && ps->has_setting("lottie/rendering/frame_budget_ms")) {
+            singleton->_budget_ms = std::max(0.0, (double)ps->get_setting("lottie/rendering/frame_budget_ms"));
+        }
+    }
+    return singleton;
+}
+
+void LottieRenderScheduler::shutdown() {
+    if (!singleton) return;
+    memdelete(singleton);
+    singleton = nullptr;
+}
+
+void LottieRenderScheduler::request(LottieAnimation *node, float priority, double cost_ms, bool on_worker) {
+    _requests.push_back(Request{node, priority, cost_ms, on_worker});
+    if (!_flush_queued) {
+        // Deferred calls are flushed after every node's _process() and before drawing.
+        _flush_queued = true;
+        callable_mp_static(&LottieRenderScheduler::_flush_deferred).call_deferred();
+    }
+}
+
+void LottieRenderScheduler::withdraw(LottieAnimation *node) {
+    _requests.erase(std::remove_if(_requests.begin(), _requests.end(), [node](const Request &r) { return r.node == node; }), _requests.end());
+}
+
+void LottieRenderScheduler::_flush_deferred() {
+    if (singleton) singleton->_flush();
+}
+
+void LottieRenderScheduler::_flush() {
+    _flush_queued = false;
+    std::vector<Request> requests;
+    requests.swap(_requests);
+    std::stable_sort(requests.begin(), requests.end(), [](const Request &a, const Request &b) { return a.priority > b.priority; });
+
+    // Worker renders run in parallel, so they get the budget once per pool thread. The pool is
+    // only queried, never created here: main-thread-only setups (web) must not spawn threads.
+    const double main_capacity = _budget_ms;
+    double worker_capacity = _budget_ms;
+    const bool any_on_worker = std::any_of(requests.begin(), requests.end(), [](const Request &r) { return r.on_worker; });
+    if (any_on_worker && LottieRenderPool::has_singleton()) {
+        worker_capacity *= (double)std::max(1, LottieRenderPool::get_singleton()->get_thread_count());
+    }
+    double main_used = 0.0;
+    double worker_used = 0.0;
+    bool admitted_any = false;
+    for (const Request &r : requests) {
+        double &used = r.on_worker ? worker_used : main_used;
+        const double capacity = r.on_worker ? worker_capacity : main_capacity;
+        // The top request always runs so that an over-budget animation still makes progress.
+        if (!admitted_any || used + r.cost_ms <= capacity) {
+            used += r.cost_ms;
+            admitted_any = true;
+            r.node->_run_scheduled_render();
+        } else {
+            r.node->_on_render_skipped();
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef LOTTIE_RENDER_SCHEDULER_H
+#define LOTTIE_RENDER_SCHEDULER_H
+
+#include <vector>
+
+namespace godot {
+
+class LottieAnimation;
+
+// Main-thread admission control for per-frame render work. Nodes that need a new frame
+// queue a request from _process(); once all nodes have processed, the scheduler runs the
+// highest-priority requests whose estimated cost fits the frame budget
+// (lottie/rendering/frame_budget_ms) and tells the rest they were skipped, so they keep
+// their last frame and rank higher next time. A budget of 0 disables scheduling.
+class LottieRenderScheduler {
+public:
+    static LottieRenderScheduler *get_singleton();
+    static void shutdown();
+
+    bool is_enabled() const { return _budget_ms > 0.0; }
+    double get_budget_ms() const { return _budget_ms; }
+
+    // on_worker: the render runs on the LottieRenderPool, so its cost is spread over the pool threads.
+    void request(LottieAnimation *node, float priority, double cost_ms, bool on_worker);
+    // Drops a pending request; called when a node is destroyed.
+    void withdraw(LottieAnimation *node);
+
+private:
+    struct Request {
+        LottieAnimation *node = nullptr;
+        float priority = 0.0f;
+        double cost_ms = 0.0;
+        bool on_worker = false;
+    };
+
+    double _budget_ms = 0.0;
+    std::vector<Request> _requests;
+    bool _flush_queued = false;
+
+    static void _flush_deferred();
+    void _flush();
+};
+
+}
+
+#endif
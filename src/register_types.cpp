@@ -1,13 +1,50 @@
 #include "register_types.h"
 #include "lottie_animation.h"
 #include "lottie_state_machine.h"
+#include "lottie_render_pool.h"
+#include "lottie_render_scheduler.h"
+#include "lottie_archive.h"
+#include "lottie_marker_index.h"
+#include "lottie_manifest.h"
+#include "lottie_frame_buffer_pool.h"
+#include "lottie_frame_cache.h"
 
 #include <gdextension_interface.h>
 #include <godot_cpp/core/defs.hpp>
 #include <godot_cpp/godot.hpp>
+#include <godot_cpp/classes/project_settings.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
 
 using namespace godot;
 
+static void _add_project_setting(const String &name, const Variant &default_value, Variant::Type type, PropertyHint hint = PROPERTY_HINT_NONE, const String &hint_string = String()) {
+    ProjectSettings *ps = ProjectSettings::get_singleton();
+    if (!ps->has_setting(name)) {
+        ps->set_setting(name, default_value);
+    }
+    ps->set_initial_value(name, default_value);
+    Dictionary info;
+    info["name"] = name;
+    info["type"] = type;
+    info["hint"] = hint;
+    info["hint_string"] = hint_string;
+    ps->add_property_info(info);
+}
+
+static void _register_project_settings() {
+    if (!ProjectSettings::get_singleton()) return;
+    // 0 = automatic (half the CPU cores, at most 8)
+    _add_project_setting("lottie/rendering/worker_threads", 0, Variant::INT, PROPERTY_HINT_RANGE, "0,64,1");
+    // Per-frame render budget in milliseconds shared by all nodes (0 = unlimited)
+    _add_project_setting("lottie/rendering/frame_budget_ms", 0.0, Variant::FLOAT, PROPERTY_HINT_RANGE, "0,100,0.1");
+    // Persist rendered frames under user://lottie_cache/frames across launches
+    _add_project_setting("lottie/frame_cache/disk_enabled", false, Variant::BOOL);
+    // Size cap of that folder; least recently used containers are deleted beyond it
+    _add_project_setting("lottie/frame_cache/disk_budget_mb", 512, Variant::INT, PROPERTY_HINT_RANGE, "16,65536,16");
+    // Store cached frames run-length encoded in memory (smaller footprint, decode on hit)
+    _add_project_setting("lottie/frame_cache/compress", false, Variant::BOOL);
+}
+
 void initialize_godot_lottie_module(ModuleInitializationLevel p_level) {
     if (p_level != MODULE_INITIALIZATION_LEVEL_SCENE) {
         return;
@@ -17,12 +54,23 @@ void initialize_godot_lottie_module(ModuleInitializationLevel p_level) {
     GDREGISTER_CLASS(LottieAnimationState);
     GDREGISTER_CLASS(LottieStateTransition);
     GDREGISTER_CLASS(LottieStateMachine);
+
+    _register_project_settings();
+    LottieFrameBufferPool::initialize();
+    LottieFrameCache::initialize();
 }
 
 void uninitialize_godot_lottie_module(ModuleInitializationLevel p_level) {
     if (p_level != MODULE_INITIALIZATION_LEVEL_SCENE) {
         return;
     }
+    LottieRenderScheduler::shutdown();
+    LottieRenderPool::shutdown();
+    LottieFrameCache::shutdown();
+    LottieFrameBufferPool::shutdown();
+    LottieManifest::clear_cache();
+    LottieArchive::clear_cache();
+    LottieMarkerIndex::clear_cache();
 }
 
 extern "C" {
@@ -0,0 +1,83 @@
+// Throughput of each pixel kernel level on a 1024x1024 frame, in megapixels per second.
+// Not part of ctest; run build_tests/bench_pixel_ops from a quiet machine. The border fix is
+// selected at compile time, so it is measured once, next to the rgb_copy version it replaced.
+#include "lottie_pixel_ops.h"
+#include "reference_kernels.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace godot;
+
+static const char *ISA_NAMES[LottiePixelOps::ISA_MAX] = { "scalar", "SSE2", "SSSE3", "AVX2", "AVX-512", "NEON" };
+static const int W = 1024;
+static const int H = 1024;
+static const int ITERATIONS = 50;
+
+// Only `kernel` is timed; `prepare` restores its input before each run of an in-place kernel.
+template <typename P, typename F>
+static double _mpix_per_s(P &&prepare, F &&kernel) {
+    prepare();
+    kernel(); // warm caches
+    double s = 0.0;
+    for (int i = 0; i < ITERATIONS; ++i) {
+        prepare();
+        const auto t0 = std::chrono::steady_clock::now();
+        kernel();
+        s += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    }
+    return (double)W * (double)H * ITERATIONS / s / 1e6;
+}
+
+template <typename F>
+static double _mpix_per_s(F &&kernel) {
+    return _mpix_per_s([]() {}, kernel);
+}
+
+int main() {
+    // Mostly transparent with translucent edges and opaque interiors, like typical vector art.
+    std::mt19937 rng(42u);
+    std::vector<uint32_t> frame((size_t)W * (size_t)H);
+    for (int y = 0; y < H; ++y) {
+        for (int x = 0; x < W; ++x) {
+            const int dx = x - W / 2, dy = y - H / 2;
+            const int d2 = dx * dx + dy * dy;
+            uint32_t a = d2 < 300 * 300 ? 255u : d2 < 320 * 320 ? rng() % 255 + 1 : 0u;
+            uint32_t c = a ? rng() % (a + 1) : 0;
+            frame[(size_t)y * W + x] = (a << 24) | (c << 16) | ((a - c / 2) << 8) | (c / 3);
+        }
+    }
+    // Every pixel translucent (soft shadows, fades): all of the unpremultiply cost is division.
+    std::vector<uint8_t> soft(frame.size() * 4);
+    for (size_t i = 0; i < frame.size(); ++i) {
+        const uint8_t a = (uint8_t)(rng() % 254 + 1);
+        soft[i * 4 + 0] = (uint8_t)(rng() % (a + 1u));
+        soft[i * 4 + 1] = (uint8_t)(rng() % (a + 1u));
+        soft[i * 4 + 2] = (uint8_t)(rng() % (a + 1u));
+        soft[i * 4 + 3] = a;
+    }
+    std::vector<uint8_t> rgba(frame.size() * 4);
+    std::vector<uint8_t> straight(frame.size() * 4);
+    std::vector<uint8_t> work(frame.size() * 4);
+    reference_argb_to_rgba(frame.data(), rgba.data(), frame.size());
+    straight = rgba;
+    reference_unpremultiply(straight.data(), frame.size());
+
+    const auto restore_straight = [&]() { work = straight; };
+    const double border_old = _mpix_per_s(restore_straight, [&]() { reference_fix_alpha_border(work.data(), W, H); });
+    const double border_new = _mpix_per_s(restore_straight, [&]() { LottiePixelOps::fix_alpha_border(work.data(), W, H, 0, 0, W, H); });
+
+    printf("fix_alpha_border: %.0f Mpix/s (rgb_copy baseline: %.0f Mpix/s)\n\n", border_new, border_old);
+    printf("%-10s %14s %14s %14s %14s %14s\n", "isa", "argb_to_rgba", "unpremultiply", "unpremul(soft)", "post(u)", "post(u+b)");
+    for (int isa = LottiePixelOps::ISA_SCALAR; isa < LottiePixelOps::ISA_MAX; ++isa) {
+        if (!LottiePixelOps::force_isa((LottiePixelOps::Isa)isa)) continue;
+        const double swizzle = _mpix_per_s([&]() { LottiePixelOps::argb_to_rgba(frame.data(), work.data(), frame.size()); });
+        const double unpremul = _mpix_per_s([&]() { work = rgba; }, [&]() { LottiePixelOps::unpremultiply(work.data(), frame.size()); });
+        const double unpremul_soft = _mpix_per_s([&]() { work = soft; }, [&]() { LottiePixelOps::unpremultiply(work.data(), frame.size()); });
+        const double post_u = _mpix_per_s([&]() { LottiePixelOps::post_process(frame.data(), work.data(), W, H, 0, 0, W, H, true, false); });
+        const double post_ub = _mpix_per_s([&]() { LottiePixelOps::post_process(frame.data(), work.data(), W, H, 0, 0, W, H, true, true); });
+        printf("%-10s %14.0f %14.0f %14.0f %14.0f %14.0f\n", ISA_NAMES[isa], swizzle, unpremul, unpremul_soft, post_u, post_ub);
+    }
+    return 0;
+}
@@ -0,0 +1,68 @@
+// Plain reference versions of the pixel kernels, shared by the tests and the benchmark.
+#ifndef LOTTIE_REFERENCE_KERNELS_H
+#define LOTTIE_REFERENCE_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// The alpha-border fix as it was before LottiePixelOps: every transparent interior pixel takes
+// the colour of its first visible 3x3 neighbour, read from a snapshot of the frame's RGB.
+inline void reference_fix_alpha_border(uint8_t *rgba, int w, int h) {
+    if (!rgba || w <= 2 || h <= 2) return;
+    std::vector<uint8_t> rgb_copy((size_t)w * (size_t)h * 3);
+    for (int y = 0; y < h; ++y) {
+        const uint8_t *row = rgba + (size_t)y * (size_t)w * 4;
+        uint8_t *dst = rgb_copy.data() + (size_t)y * (size_t)w * 3;
+        for (int x = 0; x < w; ++x) {
+            dst[x*3+0] = row[x*4+0];
+            dst[x*3+1] = row[x*4+1];
+            dst[x*3+2] = row[x*4+2];
+        }
+    }
+    auto at = [&](int x, int y)->uint8_t* { return rgba + ((size_t)y * (size_t)w + (size_t)x) * 4; };
+    auto at_rgb = [&](int x, int y)->const uint8_t* { return rgb_copy.data() + ((size_t)y * (size_t)w + (size_t)x) * 3; };
+    for (int y = 1; y < h-1; ++y) {
+        for (int x = 1; x < w-1; ++x) {
+            uint8_t *px = at(x,y);
+            if (px[3] != 0) continue;
+            bool copied = false;
+            for (int dy = -1; dy <= 1 && !copied; ++dy) {
+                for (int dx = -1; dx <= 1 && !copied; ++dx) {
+                    if (dx == 0 && dy == 0) continue;
+                    uint8_t *n = at(x+dx, y+dy);
+                    if (n[3] > 0) {
+                        const uint8_t *nrgb = at_rgb(x+dx, y+dy);
+                        px[0] = nrgb[0];
+                        px[1] = nrgb[1];
+                        px[2] = nrgb[2];
+                        copied = true;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Straight integer unpremultiply, rounding to nearest; transparent pixels become transparent black.
+inline void reference_unpremultiply(uint8_t *p, size_t count) {
+    for (size_t i = 0; i < count; ++i, p += 4) {
+        const int a = p[3];
+        for (int c = 0; c < 3; ++c) {
+            const int v = a == 0 ? 0 : (p[c] * 255 + a / 2) / a;
+            p[c] = (uint8_t)(v > 255 ? 255 : v);
+        }
+    }
+}
+
+// ThorVG ARGB8888 words to RGBA8 bytes.
+inline void reference_argb_to_rgba(const uint32_t *src, uint8_t *dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i*4+0] = (uint8_t)(src[i] >> 16);
+        dst[i*4+1] = (uint8_t)(src[i] >> 8);
+        dst[i*4+2] = (uint8_t)src[i];
+        dst[i*4+3] = (uint8_t)(src[i] >> 24);
+    }
+}
+
+#endif
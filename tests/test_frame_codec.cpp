@@ -0,0 +1,123 @@
+// Round-trips LottieFrameCodec over flat, random and mixed frames and checks that malformed or
+// truncated streams are rejected. Exits non-zero on the first failure.
+#include "lottie_frame_codec.h"
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace godot;
+
+static bool _round_trip(const char *name, const std::vector<uint8_t> &rgba, size_t *r_size = nullptr) {
+    const size_t pixels = rgba.size() / 4;
+    std::vector<uint8_t> stream(LottieFrameCodec::max_encoded_size(pixels));
+    const size_t n = LottieFrameCodec::encode(rgba.data(), pixels, stream.data(), stream.size());
+    if (pixels != 0 && n == 0) {
+        printf("FAIL %s: encode did not fit its own bound\n", name);
+        return false;
+    }
+    std::vector<uint8_t> out(rgba.size() + 4, 0xCD);
+    if (!LottieFrameCodec::decode(stream.data(), n, out.data(), pixels) || memcmp(out.data(), rgba.data(), rgba.size()) != 0) {
+        printf("FAIL %s: round trip differs\n", name);
+        return false;
+    }
+    if (out[rgba.size()] != 0xCD) {
+        printf("FAIL %s: decode wrote past the frame\n", name);
+        return false;
+    }
+    if (r_size) *r_size = n;
+    return true;
+}
+
+// Horizontal bands of flat colour, transparent gaps and noise, like a typical Lottie frame.
+static std::vector<uint8_t> _mixed_frame(int w, int h, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> rgba((size_t)w * (size_t)h * 4, 0);
+    for (size_t i = 0; i < (size_t)w * (size_t)h;) {
+        const size_t run = std::min((size_t)w * (size_t)h - i, (size_t)(rng() % 300 + 1));
+        const uint32_t kind = rng() % 3;
+        const uint8_t flat[4] = { (uint8_t)rng(), (uint8_t)rng(), (uint8_t)rng(), 255 };
+        for (size_t k = 0; k < run; ++k, ++i) {
+            for (int c = 0; c < 4; ++c) {
+                rgba[i * 4 + c] = kind == 0 ? 0 : kind == 1 ? flat[c] : (uint8_t)rng();
+            }
+        }
+    }
+    return rgba;
+}
+
+int main() {
+    bool ok = true;
+
+    ok &= _round_trip("empty", {});
+    ok &= _round_trip("one pixel", { 1, 2, 3, 4 });
+    ok &= _round_trip("two equal", { 1, 2, 3, 4, 1, 2, 3, 4 });
+    ok &= _round_trip("three equal", { 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9 });
+
+    size_t flat_size = 0;
+    ok &= _round_trip("transparent 256x256", std::vector<uint8_t>(256 * 256 * 4, 0), &flat_size);
+    if (flat_size > 16) {
+        printf("FAIL transparent frame encoded to %zu bytes\n", flat_size);
+        ok = false;
+    }
+
+    std::vector<uint8_t> tinted(97 * 53 * 4);
+    for (size_t i = 0; i < tinted.size(); i += 4) {
+        tinted[i] = 10; tinted[i + 1] = 20; tinted[i + 2] = 30; tinted[i + 3] = 255;
+    }
+    ok &= _round_trip("flat colour", tinted);
+
+    std::mt19937 rng(7);
+    std::vector<uint8_t> noise(131 * 67 * 4);
+    for (uint8_t &b : noise) b = (uint8_t)rng();
+    ok &= _round_trip("noise", noise);
+
+    for (uint32_t seed = 1; seed <= 8; ++seed) {
+        size_t n = 0;
+        const std::vector<uint8_t> frame = _mixed_frame(173, 91, seed);
+        ok &= _round_trip("mixed", frame, &n);
+        if (n >= frame.size()) {
+            printf("FAIL mixed frame %u did not shrink (%zu of %zu bytes)\n", seed, n, frame.size());
+            ok = false;
+        }
+    }
+
+    // A capacity below the stream size makes encode give up instead of overrunning.
+    {
+        std::vector<uint8_t> stream(noise.size() / 2);
+        if (LottieFrameCodec::encode(noise.data(), noise.size() / 4, stream.data(), stream.size()) != 0) {
+            printf("FAIL encode ignored its capacity\n");
+            ok = false;
+        }
+    }
+
+    // Truncated, oversized and garbage streams are rejected.
+    {
+        const std::vector<uint8_t> frame = _mixed_frame(64, 64, 99);
+        const size_t pixels = frame.size() / 4;
+        std::vector<uint8_t> stream(LottieFrameCodec::max_encoded_size(pixels));
+        const size_t n = LottieFrameCodec::encode(frame.data(), pixels, stream.data(), stream.size());
+        std::vector<uint8_t> out(frame.size());
+        if (LottieFrameCodec::decode(stream.data(), n - 1, out.data(), pixels)) {
+            printf("FAIL truncated stream accepted\n");
+            ok = false;
+        }
+        if (LottieFrameCodec::decode(stream.data(), n, out.data(), pixels - 1)) {
+            printf("FAIL stream longer than the frame accepted\n");
+            ok = false;
+        }
+        if (LottieFrameCodec::decode(stream.data(), n, out.data(), pixels + 1)) {
+            printf("FAIL stream shorter than the frame accepted\n");
+            ok = false;
+        }
+        std::vector<uint8_t> garbage(n);
+        for (uint8_t &b : garbage) b = (uint8_t)rng() | 0x80;
+        if (LottieFrameCodec::decode(garbage.data(), garbage.size(), out.data(), pixels)) {
+            printf("FAIL garbage stream accepted\n");
+            ok = false;
+        }
+    }
+
+    printf(ok ? "frame codec: all round trips passed\n" : "frame codec: FAILED\n");
+    return ok ? 0 : 1;
+}
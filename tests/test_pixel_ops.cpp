@@ -0,0 +1,191 @@
+// Runs every pixel kernel level this CPU supports and compares it byte for byte with the
+// scalar kernels, then checks every level against the plain reference versions in
+// reference_kernels.h. The SIMD alpha-border fix is chosen at compile time, so that oracle is
+// also run over masks built to hit its group skipping and tails. Exits non-zero on a mismatch.
+#include "lottie_pixel_ops.h"
+#include "reference_kernels.h"
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace godot;
+
+static const char *ISA_NAMES[LottiePixelOps::ISA_MAX] = { "scalar", "SSE2", "SSSE3", "AVX2", "AVX-512", "NEON" };
+
+// Every (colour, alpha) pair once per channel; the count is odd so the scalar tails run too.
+static std::vector<uint8_t> _all_unpremultiplied_inputs() {
+    std::vector<uint8_t> px;
+    for (int a = 0; a < 256; ++a) {
+        for (int c = 0; c < 256; ++c) {
+            px.push_back((uint8_t)c);
+            px.push_back((uint8_t)(255 - c));
+            px.push_back((uint8_t)(c ^ 0x5A));
+            px.push_back((uint8_t)a);
+        }
+    }
+    for (int k = 0; k < 4 * 13; ++k) px.push_back((uint8_t)(k * 37));
+    return px;
+}
+
+// A frame of random ARGB words with opaque, transparent and translucent runs, like ThorVG output.
+static std::vector<uint32_t> _random_frame(int w, int h, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint32_t> frame((size_t)w * (size_t)h);
+    for (size_t i = 0; i < frame.size();) {
+        size_t run = std::min(frame.size() - i, (size_t)(rng() % 40 + 1));
+        const uint32_t kind = rng() % 3;
+        for (size_t k = 0; k < run; ++k, ++i) {
+            uint32_t a = kind == 0 ? 0u : kind == 1 ? 255u : rng() % 256;
+            uint32_t r = a ? rng() % (a + 1) : 0, g = a ? rng() % (a + 1) : 0, b = a ? rng() % (a + 1) : 0;
+            frame[i] = (a << 24) | (r << 16) | (g << 8) | b;
+        }
+    }
+    return frame;
+}
+
+struct Outputs {
+    std::vector<uint8_t> unpremultiplied;
+    std::vector<uint8_t> swizzled;
+    std::vector<uint8_t> processed[4]; // post_process with each (unpremultiply, fix_border) pair
+};
+
+static const int W = 67;
+static const int H = 41;
+
+static Outputs _run_kernels(const std::vector<uint8_t> &straight_in, const std::vector<uint32_t> &frame) {
+    Outputs o;
+    o.unpremultiplied = straight_in;
+    LottiePixelOps::unpremultiply(o.unpremultiplied.data(), o.unpremultiplied.size() / 4);
+    o.swizzled.resize(frame.size() * 4);
+    LottiePixelOps::argb_to_rgba(frame.data(), o.swizzled.data(), frame.size());
+    for (int m = 0; m < 4; ++m) {
+        o.processed[m].assign(frame.size() * 4, 0xCD);
+        LottiePixelOps::post_process(frame.data(), o.processed[m].data(), W, H, 3, 2, W - 5, H - 1, (m & 1) != 0, (m & 2) != 0);
+    }
+    return o;
+}
+
+static bool _same(const char *isa, const char *what, const std::vector<uint8_t> &got, const std::vector<uint8_t> &want) {
+    if (got.size() != want.size()) {
+        printf("FAIL %s %s: size %zu != %zu\n", isa, what, got.size(), want.size());
+        return false;
+    }
+    for (size_t i = 0; i < got.size(); ++i) {
+        if (got[i] != want[i]) {
+            printf("FAIL %s %s: byte %zu (pixel %zu) is %d, expected %d\n", isa, what, i, i / 4, got[i], want[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Alpha masks for the border fix, each with random colour under transparent pixels too so a
+// wrong read of a transparent neighbour shows up.
+enum Mask {
+    MASK_RANDOM,
+    MASK_SPARSE,
+    MASK_CHECKER,
+    MASK_STRIPES,
+    MASK_BORDER_ONLY,
+    MASK_ISLANDS,
+    MASK_MAX,
+};
+static const char *MASK_NAMES[MASK_MAX] = { "random", "sparse", "checker", "stripes", "border-only", "islands" };
+
+static std::vector<uint8_t> _mask_frame(Mask mask, int w, int h, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> rgba((size_t)w * (size_t)h * 4);
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            bool visible = false;
+            switch (mask) {
+                case MASK_RANDOM: visible = rng() % 2 == 0; break;
+                case MASK_SPARSE: visible = rng() % 29 == 0; break;
+                case MASK_CHECKER: visible = ((x ^ y) & 1) != 0; break;
+                case MASK_STRIPES: visible = (x % 7) < 1 + y % 5; break; // widths cross 4-pixel groups
+                case MASK_BORDER_ONLY: visible = x == 0 || y == 0 || x == w - 1 || y == h - 1; break;
+                case MASK_ISLANDS: visible = x % 9 == 4 && y % 6 == 3; break;
+                default: break;
+            }
+            uint8_t *px = rgba.data() + ((size_t)y * (size_t)w + (size_t)x) * 4;
+            px[0] = (uint8_t)rng();
+            px[1] = (uint8_t)rng();
+            px[2] = (uint8_t)rng();
+            px[3] = visible ? (uint8_t)(rng() % 255 + 1) : 0;
+        }
+    }
+    return rgba;
+}
+
+static bool _check_border_oracle() {
+    static const int SIZES[][2] = { { 67, 41 }, { 3, 3 }, { 4, 9 }, { 5, 5 }, { 6, 7 }, { 9, 4 }, { 130, 17 } };
+    bool ok = true;
+    for (int m = 0; m < MASK_MAX; ++m) {
+        for (const auto &size : SIZES) {
+            const int w = size[0], h = size[1];
+            const std::vector<uint8_t> in = _mask_frame((Mask)m, w, h, (uint32_t)(m * 1000 + w * 31 + h));
+            std::vector<uint8_t> want = in;
+            reference_fix_alpha_border(want.data(), w, h);
+            std::vector<uint8_t> got = in;
+            LottiePixelOps::fix_alpha_border(got.data(), w, h, 0, 0, w, h);
+            char what[96];
+            snprintf(what, sizeof(what), "fix_alpha_border(%s, %dx%d)", MASK_NAMES[m], w, h);
+            ok = _same("reference", what, got, want) && ok;
+        }
+    }
+    return ok;
+}
+
+// Every level against the reference kernels on a full frame, including the fused post_process.
+static bool _check_reference(const char *isa, const std::vector<uint8_t> &straight_in, const std::vector<uint32_t> &frame) {
+    std::vector<uint8_t> want = straight_in;
+    reference_unpremultiply(want.data(), want.size() / 4);
+    std::vector<uint8_t> got = straight_in;
+    LottiePixelOps::unpremultiply(got.data(), got.size() / 4);
+    bool ok = _same(isa, "unpremultiply vs reference", got, want);
+
+    want.assign(frame.size() * 4, 0);
+    reference_argb_to_rgba(frame.data(), want.data(), frame.size());
+    reference_unpremultiply(want.data(), frame.size());
+    reference_fix_alpha_border(want.data(), W, H);
+    got.assign(frame.size() * 4, 0xCD);
+    LottiePixelOps::post_process(frame.data(), got.data(), W, H, 0, 0, W, H, true, true);
+    return _same(isa, "post_process vs reference", got, want) && ok;
+}
+
+int main() {
+    const std::vector<uint8_t> straight_in = _all_unpremultiplied_inputs();
+    const std::vector<uint32_t> frame = _random_frame(W, H, 1234u);
+
+    if (!LottiePixelOps::force_isa(LottiePixelOps::ISA_SCALAR)) {
+        printf("FAIL scalar kernels unavailable\n");
+        return 1;
+    }
+    const Outputs ref = _run_kernels(straight_in, frame);
+
+    bool ok = _check_reference(ISA_NAMES[LottiePixelOps::ISA_SCALAR], straight_in, frame);
+    ok = _check_border_oracle() && ok;
+    printf("%s reference kernels and border-fix oracle\n", ok ? "ok  " : "FAIL");
+    int tested = 0;
+    for (int isa = LottiePixelOps::ISA_SSE2; isa < LottiePixelOps::ISA_MAX; ++isa) {
+        if (!LottiePixelOps::force_isa((LottiePixelOps::Isa)isa)) {
+            printf("skip %s (not supported here)\n", ISA_NAMES[isa]);
+            continue;
+        }
+        const Outputs got = _run_kernels(straight_in, frame);
+        bool isa_ok = _check_reference(ISA_NAMES[isa], straight_in, frame);
+        isa_ok = _same(ISA_NAMES[isa], "unpremultiply", got.unpremultiplied, ref.unpremultiplied) && isa_ok;
+        isa_ok = _same(ISA_NAMES[isa], "argb_to_rgba", got.swizzled, ref.swizzled) && isa_ok;
+        for (int m = 0; m < 4; ++m) {
+            char what[64];
+            snprintf(what, sizeof(what), "post_process(unpremultiply=%d, fix_border=%d)", m & 1, (m >> 1) & 1);
+            isa_ok = _same(ISA_NAMES[isa], what, got.processed[m], ref.processed[m]) && isa_ok;
+        }
+        printf("%s %s\n", isa_ok ? "ok  " : "FAIL", ISA_NAMES[isa]);
+        ok = ok && isa_ok;
+        tested++;
+    }
+    printf("%d vector level(s) checked against scalar\n", tested);
+    return ok ? 0 : 1;
+}